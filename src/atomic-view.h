@@ -0,0 +1,218 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+inline constexpr size_t cache_line_size = 64;
+
+template <typename T, size_t Extent = dynamic_extent>
+class atomic_view {
+  static_assert(!std::is_const_v<T>, "atomic_view requires mutable elements");
+  static_assert(std::is_trivially_copyable_v<T>);
+
+public:
+  using value_type = T;
+  using view_type = contiguous_view<T, Extent>;
+
+private:
+  view_type _view;
+
+  std::atomic_ref<T> ref(size_t idx) const {
+    runtime_assert(idx < size(), "Index must be lower than size.");
+    return std::atomic_ref<T>(_view.data()[idx]);
+  }
+
+public:
+  atomic_view()
+    requires (Extent == dynamic_extent || Extent == 0)
+  = default;
+
+  explicit atomic_view(view_type view)
+      : _view(view) {
+    runtime_assert(
+        reinterpret_cast<std::uintptr_t>(view.data()) % std::atomic_ref<T>::required_alignment == 0,
+        "Elements must satisfy atomic_ref alignment."
+    );
+  }
+
+  view_type view() const noexcept {
+    return _view;
+  }
+
+  size_t size() const noexcept {
+    return _view.size();
+  }
+
+  bool empty() const noexcept {
+    return _view.empty();
+  }
+
+  T load(size_t idx, std::memory_order order = std::memory_order_seq_cst) const {
+    return ref(idx).load(order);
+  }
+
+  void store(size_t idx, T value, std::memory_order order = std::memory_order_seq_cst) const {
+    ref(idx).store(value, order);
+  }
+
+  T exchange(size_t idx, T value, std::memory_order order = std::memory_order_seq_cst) const {
+    return ref(idx).exchange(value, order);
+  }
+
+  bool compare_exchange_weak(
+      size_t idx,
+      T& expected,
+      T desired,
+      std::memory_order order = std::memory_order_seq_cst
+  ) const {
+    return ref(idx).compare_exchange_weak(expected, desired, order);
+  }
+
+  bool compare_exchange_strong(
+      size_t idx,
+      T& expected,
+      T desired,
+      std::memory_order order = std::memory_order_seq_cst
+  ) const {
+    return ref(idx).compare_exchange_strong(expected, desired, order);
+  }
+
+  bool compare_exchange_strong(
+      size_t idx,
+      T& expected,
+      T desired,
+      std::memory_order success,
+      std::memory_order failure
+  ) const {
+    return ref(idx).compare_exchange_strong(expected, desired, success, failure);
+  }
+
+  T fetch_add(size_t idx, T arg, std::memory_order order = std::memory_order_seq_cst) const
+    requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+  {
+    return ref(idx).fetch_add(arg, order);
+  }
+
+  T fetch_sub(size_t idx, T arg, std::memory_order order = std::memory_order_seq_cst) const
+    requires (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>)
+  {
+    return ref(idx).fetch_sub(arg, order);
+  }
+
+  T fetch_and(size_t idx, T arg, std::memory_order order = std::memory_order_seq_cst) const
+    requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+  {
+    return ref(idx).fetch_and(arg, order);
+  }
+
+  T fetch_or(size_t idx, T arg, std::memory_order order = std::memory_order_seq_cst) const
+    requires (std::is_integral_v<T> && !std::is_same_v<T, bool>)
+  {
+    return ref(idx).fetch_or(arg, order);
+  }
+
+  atomic_view<T, dynamic_extent> subview(size_t offset, size_t count = dynamic_extent) const {
+    return atomic_view<T, dynamic_extent>(_view.subview(offset, count));
+  }
+};
+
+template <typename T, size_t Extent>
+atomic_view(contiguous_view<T, Extent>) -> atomic_view<T, Extent>;
+
+// Small dense number for the calling thread, handed out round-robin on first
+// use: the first N threads to ask get 0 .. N - 1.
+inline size_t this_thread_slot() {
+  static std::atomic<size_t> next{0};
+  thread_local const size_t slot = next.fetch_add(1, std::memory_order_relaxed);
+  return slot;
+}
+
+// Per-shard copies of the bins, each starting on its own cache line, so that
+// threads hitting the same hot bin through different shards never share a line.
+template <typename Counter = std::uint64_t>
+class striped_histogram {
+  static_assert(std::is_integral_v<Counter>);
+
+  static constexpr size_t counters_per_line = cache_line_size / sizeof(Counter);
+
+  size_t _bins;
+  size_t _stride;
+  size_t _shards;
+  std::vector<Counter> _storage;
+
+  Counter* base() {
+    auto addr = reinterpret_cast<std::uintptr_t>(_storage.data());
+    return _storage.data() + (cache_line_size - addr % cache_line_size) % cache_line_size / sizeof(Counter);
+  }
+
+  const Counter* base() const {
+    return const_cast<striped_histogram*>(this)->base();
+  }
+
+public:
+  striped_histogram(size_t bins, size_t shards = std::thread::hardware_concurrency())
+      : _bins(bins)
+      , _stride(std::max<size_t>(1, (bins + counters_per_line - 1) / counters_per_line) * counters_per_line)
+      , _shards(std::max<size_t>(1, shards))
+      , _storage(_stride * _shards + counters_per_line) {}
+
+  size_t bins() const noexcept {
+    return _bins;
+  }
+
+  size_t shards() const noexcept {
+    return _shards;
+  }
+
+  // Threads get distinct shards until there are more of them than shards;
+  // after that shards are shared round-robin, which stays correct but brings
+  // back contention. Callers with their own worker index can pass it to
+  // `add_to_shard` instead.
+  size_t shard_for_this_thread() const {
+    return this_thread_slot() % _shards;
+  }
+
+  atomic_view<Counter> shard(size_t idx) {
+    runtime_assert(idx < shards(), "Shard index must be lower than shard count.");
+    return atomic_view<Counter>(contiguous_view<Counter>(base() + idx * _stride, _bins));
+  }
+
+  // Hot path: one bounds check and a relaxed add, no view construction.
+  void add_to_shard(size_t shard_idx, size_t bin, Counter count = 1) {
+    runtime_assert(bin < _bins, "Bin must be lower than bin count.");
+    runtime_assert(shard_idx < _shards, "Shard index must be lower than shard count.");
+    std::atomic_ref<Counter>(base()[shard_idx * _stride + bin]).fetch_add(count, std::memory_order_relaxed);
+  }
+
+  void add(size_t bin, Counter count = 1) {
+    add_to_shard(shard_for_this_thread(), bin, count);
+  }
+
+  // Sums all shards into `out`. The inner loop runs over contiguous bins so
+  // the compiler turns it into a vector add; reads are not synchronized with
+  // concurrent `add` calls, so merge after the writers have been joined.
+  void merge_into(contiguous_view<Counter> out) const {
+    runtime_assert(out.size() == _bins, "Output size must match bin count.");
+    Counter* dst = out.data();
+    for (size_t i = 0; i < _bins; ++i) {
+      dst[i] = 0;
+    }
+    for (size_t s = 0; s < shards(); ++s) {
+      const Counter* src = base() + s * _stride;
+      for (size_t i = 0; i < _bins; ++i) {
+        dst[i] += src[i];
+      }
+    }
+  }
+
+  void clear() {
+    std::fill(_storage.begin(), _storage.end(), Counter{});
+  }
+};
@@ -0,0 +1,278 @@
+#include "checksum.h"
+
+#include <array>
+#include <cstring>
+#include <limits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define CHECKSUM_HAS_X86_DISPATCH 1
+#endif
+
+namespace {
+
+using byte = unsigned char;
+
+inline constexpr std::uint32_t crc32c_poly = 0x82F63B78;
+inline constexpr std::uint32_t crc32_poly = 0xEDB88320;
+inline constexpr std::uint64_t crc64_poly = 0xC96C5795D7870F42;
+
+// All arithmetic below works on the raw CRC register: no initial or final
+// inversion. Bit i of a W-bit value is the coefficient of x^(W - 1 - i).
+template <typename U, U Poly>
+struct crc_math {
+  using value_type = U;
+  static constexpr size_t width = std::numeric_limits<U>::digits;
+
+  static constexpr std::array<std::array<U, 256>, 8> make_tables() {
+    std::array<std::array<U, 256>, 8> tables{};
+    for (size_t i = 0; i < 256; ++i) {
+      U crc = static_cast<U>(i);
+      for (int bit = 0; bit < 8; ++bit) {
+        crc = crc & 1 ? (crc >> 1) ^ Poly : crc >> 1;
+      }
+      tables[0][i] = crc;
+    }
+    for (size_t i = 0; i < 256; ++i) {
+      for (size_t t = 1; t < 8; ++t) {
+        tables[t][i] = (tables[t - 1][i] >> 8) ^ tables[0][tables[t - 1][i] & 0xFF];
+      }
+    }
+    return tables;
+  }
+
+  static constexpr std::array<std::array<U, 256>, 8> tables = make_tables();
+
+  static U update_bytes(U crc, const byte* p, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+      crc = (crc >> 8) ^ tables[0][(crc ^ p[i]) & 0xFF];
+    }
+    return crc;
+  }
+
+  // Slicing-by-8: eight table lookups per 8-byte word instead of a chain of
+  // eight dependent ones.
+  static U update(U crc, const byte* p, size_t n) {
+    for (; n >= 8; n -= 8, p += 8) {
+      std::uint64_t word;
+      std::memcpy(&word, p, 8);
+      word ^= crc;
+      crc = tables[7][word & 0xFF] ^ tables[6][(word >> 8) & 0xFF] ^ tables[5][(word >> 16) & 0xFF] ^
+            tables[4][(word >> 24) & 0xFF] ^ tables[3][(word >> 32) & 0xFF] ^ tables[2][(word >> 40) & 0xFF] ^
+            tables[1][(word >> 48) & 0xFF] ^ tables[0][word >> 56];
+    }
+    return update_bytes(crc, p, n);
+  }
+
+  // a * b mod P
+  static U multiply(U a, U b) {
+    U result = 0;
+    for (U m = U(1) << (width - 1); a != 0 && m != 0; m >>= 1) {
+      if (a & m) {
+        result ^= b;
+        a ^= m;
+      }
+      b = b & 1 ? (b >> 1) ^ Poly : b >> 1;
+    }
+    return result;
+  }
+
+  // x^e mod P
+  static U x_pow(unsigned long long e) {
+    U result = U(1) << (width - 1);
+    U base = U(1) << (width - 2);
+    for (; e != 0; e >>= 1) {
+      if (e & 1) {
+        result = multiply(result, base);
+      }
+      base = multiply(base, base);
+    }
+    return result;
+  }
+
+  // Register after feeding `bytes` zero bytes.
+  static U shift(U crc, size_t bytes) {
+    return multiply(x_pow(8ull * bytes), crc);
+  }
+
+  static U combine(U crc_a, U crc_b, size_t len_b) {
+    return shift(crc_a, len_b) ^ crc_b;
+  }
+
+  // x^e mod P in the 64-bit reflected layout used by the PCLMUL folding.
+  static std::uint64_t fold_constant(unsigned long long e) {
+    return static_cast<std::uint64_t>(x_pow(e)) << (64 - width);
+  }
+};
+
+using crc32c_math = crc_math<std::uint32_t, crc32c_poly>;
+using crc32_math = crc_math<std::uint32_t, crc32_poly>;
+using crc64_math = crc_math<std::uint64_t, crc64_poly>;
+
+#ifdef CHECKSUM_HAS_X86_DISPATCH
+
+// Three independent crc32 chains hide the instruction's 3-cycle latency; the
+// partial registers are merged by shifting them over the blocks that follow.
+constexpr size_t crc32c_block = 4096;
+
+__attribute__((target("sse4.2"))) std::uint32_t crc32c_sse42(std::uint32_t crc, const byte* p, size_t n) {
+  static const std::uint32_t shift_one = crc32c_math::x_pow(8ull * crc32c_block);
+  static const std::uint32_t shift_two = crc32c_math::x_pow(8ull * 2 * crc32c_block);
+
+  for (; n >= 3 * crc32c_block; n -= 3 * crc32c_block, p += 3 * crc32c_block) {
+    std::uint64_t a = crc;
+    std::uint64_t b = 0;
+    std::uint64_t c = 0;
+    for (size_t i = 0; i < crc32c_block; i += 8) {
+      std::uint64_t wa;
+      std::uint64_t wb;
+      std::uint64_t wc;
+      std::memcpy(&wa, p + i, 8);
+      std::memcpy(&wb, p + crc32c_block + i, 8);
+      std::memcpy(&wc, p + 2 * crc32c_block + i, 8);
+      a = _mm_crc32_u64(a, wa);
+      b = _mm_crc32_u64(b, wb);
+      c = _mm_crc32_u64(c, wc);
+    }
+    crc = crc32c_math::multiply(shift_two, static_cast<std::uint32_t>(a)) ^
+          crc32c_math::multiply(shift_one, static_cast<std::uint32_t>(b)) ^ static_cast<std::uint32_t>(c);
+  }
+
+  std::uint64_t wide = crc;
+  for (; n >= 8; n -= 8, p += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, p, 8);
+    wide = _mm_crc32_u64(wide, word);
+  }
+  crc = static_cast<std::uint32_t>(wide);
+  for (; n > 0; --n, ++p) {
+    crc = _mm_crc32_u8(crc, *p);
+  }
+  return crc;
+}
+
+inline __m128i load(const byte* at) {
+  return _mm_loadu_si128(reinterpret_cast<const __m128i*>(at));
+}
+
+__attribute__((target("pclmul"))) inline __m128i fold(__m128i x, __m128i k) {
+  return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x00), _mm_clmulepi64_si128(x, k, 0x11));
+}
+
+// Folds four 128-bit lanes across 512 bits, then into one lane, then hands
+// the remaining lane and tail bytes to the table code. For a lane with
+// halves H (low qword, higher degrees) and L, R * x^D = H * x^(D + 64) +
+// L * x^D; the reflected clmul contributes one extra factor of x, hence the
+// -1 in the exponents.
+template <typename Math>
+__attribute__((target("pclmul"))) typename Math::value_type
+crc_pclmul(typename Math::value_type crc, const byte* p, size_t n) {
+  using U = typename Math::value_type;
+  if (n < 64) {
+    return Math::update(crc, p, n);
+  }
+
+  static const __m128i fold_512 = _mm_set_epi64x(
+      static_cast<long long>(Math::fold_constant(512 - 1)),
+      static_cast<long long>(Math::fold_constant(512 + 63))
+  );
+  static const __m128i fold_128 = _mm_set_epi64x(
+      static_cast<long long>(Math::fold_constant(128 - 1)),
+      static_cast<long long>(Math::fold_constant(128 + 63))
+  );
+
+  __m128i x0 = _mm_xor_si128(load(p), _mm_set_epi64x(0, static_cast<long long>(crc)));
+  __m128i x1 = load(p + 16);
+  __m128i x2 = load(p + 32);
+  __m128i x3 = load(p + 48);
+  p += 64;
+  n -= 64;
+
+  for (; n >= 64; n -= 64, p += 64) {
+    x0 = _mm_xor_si128(fold(x0, fold_512), load(p));
+    x1 = _mm_xor_si128(fold(x1, fold_512), load(p + 16));
+    x2 = _mm_xor_si128(fold(x2, fold_512), load(p + 32));
+    x3 = _mm_xor_si128(fold(x3, fold_512), load(p + 48));
+  }
+
+  __m128i x = _mm_xor_si128(fold(x0, fold_128), x1);
+  x = _mm_xor_si128(fold(x, fold_128), x2);
+  x = _mm_xor_si128(fold(x, fold_128), x3);
+  for (; n >= 16; n -= 16, p += 16) {
+    x = _mm_xor_si128(fold(x, fold_128), load(p));
+  }
+
+  byte lane[16];
+  _mm_storeu_si128(reinterpret_cast<__m128i*>(lane), x);
+  U result = Math::update(U(0), lane, 16);
+  return Math::update(result, p, n);
+}
+
+bool has_sse42() {
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+}
+
+bool has_pclmul() {
+  static const bool supported = __builtin_cpu_supports("pclmul");
+  return supported;
+}
+
+#endif
+
+const byte* bytes_of(byte_view data) {
+  return reinterpret_cast<const byte*>(data.data());
+}
+
+} // namespace
+
+std::uint32_t crc32c_portable(byte_view data, std::uint32_t crc) {
+  return ~crc32c_math::update(~crc, bytes_of(data), data.size());
+}
+
+std::uint32_t crc32_portable(byte_view data, std::uint32_t crc) {
+  return ~crc32_math::update(~crc, bytes_of(data), data.size());
+}
+
+std::uint64_t crc64_portable(byte_view data, std::uint64_t crc) {
+  return ~crc64_math::update(~crc, bytes_of(data), data.size());
+}
+
+std::uint32_t crc32c(byte_view data, std::uint32_t crc) {
+#ifdef CHECKSUM_HAS_X86_DISPATCH
+  if (has_sse42()) {
+    return ~crc32c_sse42(~crc, bytes_of(data), data.size());
+  }
+#endif
+  return crc32c_portable(data, crc);
+}
+
+std::uint32_t crc32(byte_view data, std::uint32_t crc) {
+#ifdef CHECKSUM_HAS_X86_DISPATCH
+  if (has_pclmul()) {
+    return ~crc_pclmul<crc32_math>(~crc, bytes_of(data), data.size());
+  }
+#endif
+  return crc32_portable(data, crc);
+}
+
+std::uint64_t crc64(byte_view data, std::uint64_t crc) {
+#ifdef CHECKSUM_HAS_X86_DISPATCH
+  if (has_pclmul()) {
+    return ~crc_pclmul<crc64_math>(~crc, bytes_of(data), data.size());
+  }
+#endif
+  return crc64_portable(data, crc);
+}
+
+std::uint32_t crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, size_t len_b) {
+  return crc32c_math::combine(crc_a, crc_b, len_b);
+}
+
+std::uint32_t crc32_combine(std::uint32_t crc_a, std::uint32_t crc_b, size_t len_b) {
+  return crc32_math::combine(crc_a, crc_b, len_b);
+}
+
+std::uint64_t crc64_combine(std::uint64_t crc_a, std::uint64_t crc_b, size_t len_b) {
+  return crc64_math::combine(crc_a, crc_b, len_b);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <cstddef>
+#include <cstdint>
+
+using byte_view = contiguous_view<const std::byte>;
+
+// Reflected CRCs with all-ones initial value and final xor, the variants used
+// by iSCSI/ext4 (CRC32C), zlib/Ethernet (CRC32) and xz (CRC64, ECMA-182
+// polynomial). Passing the result of a previous call as `crc` continues the
+// computation, so `crc32c(b, crc32c(a)) == crc32c(a + b)`.
+//
+// CRC32C uses the SSE4.2 `crc32` instruction, CRC32 and CRC64 fold 64-byte
+// blocks with PCLMULQDQ; both are picked at runtime when the CPU supports
+// them, with slicing-by-8 tables as the portable fallback.
+std::uint32_t crc32c(byte_view data, std::uint32_t crc = 0);
+std::uint32_t crc32(byte_view data, std::uint32_t crc = 0);
+std::uint64_t crc64(byte_view data, std::uint64_t crc = 0);
+
+// Checksum of `a + b` from the checksums of `a` and `b` and the length of
+// `b`, so chunks hashed in parallel can be merged: O(log(len_b)).
+std::uint32_t crc32c_combine(std::uint32_t crc_a, std::uint32_t crc_b, size_t len_b);
+std::uint32_t crc32_combine(std::uint32_t crc_a, std::uint32_t crc_b, size_t len_b);
+std::uint64_t crc64_combine(std::uint64_t crc_a, std::uint64_t crc_b, size_t len_b);
+
+// Same results as above, but always the table-driven implementation.
+std::uint32_t crc32c_portable(byte_view data, std::uint32_t crc = 0);
+std::uint32_t crc32_portable(byte_view data, std::uint32_t crc = 0);
+std::uint64_t crc64_portable(byte_view data, std::uint64_t crc = 0);
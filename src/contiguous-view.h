@@ -1,6 +1,7 @@
 #pragma once
 
 #include "runtime-assert.h"
+#include "view-instrumentation.h"
 
 #include <cstddef>
 #include <memory>
@@ -54,16 +55,17 @@ public:
       , size_(0) {}
 
   template <typename It>
-  explicit(Extent != dynamic_extent) contiguous_view(It first, size_t count)
+  explicit(Extent != dynamic_extent) contiguous_view(It first, size_t count VIEW_SITE_PARAM)
       : _first(std::to_address(first))
       , size_(count) {
-    runtime_assert(count <= size(), "no");
+    runtime_assert(count <= size(), "no" VIEW_SITE_ARG);
+    VIEW_RECORD_VIEW(_first, count, Extent == dynamic_extent);
   }
 
   template <typename It>
-  explicit(Extent != dynamic_extent) contiguous_view(It first, It last)
-      : contiguous_view(std::to_address(first), last - first) {
-    runtime_assert((first <= last && std::distance(first, last) <= static_cast<ptrdiff_t>(size())), "no");
+  explicit(Extent != dynamic_extent) contiguous_view(It first, It last VIEW_SITE_PARAM)
+      : contiguous_view(std::to_address(first), last - first VIEW_SITE_ARG) {
+    runtime_assert((first <= last && std::distance(first, last) <= static_cast<ptrdiff_t>(size())), "no" VIEW_SITE_ARG);
   }
 
   contiguous_view(const contiguous_view& other) noexcept = default;
@@ -71,10 +73,13 @@ public:
   template <typename U, size_t N>
     requires (!(std::is_same_v<U, std::remove_const_t<T>>) || N == dynamic_extent || Extent == dynamic_extent ||
               N == Extent)
-  explicit(Extent != dynamic_extent && Extent != N) contiguous_view(const contiguous_view<U, N>& other) noexcept
+  explicit(Extent != dynamic_extent && Extent != N) contiguous_view(
+      const contiguous_view<U, N>& other VIEW_SITE_PARAM
+  ) noexcept
       : _first(other.begin())
       , size_(other.size()) {
-    runtime_assert(other.size() <= size(), "no");
+    runtime_assert(other.size() <= size(), "no" VIEW_SITE_ARG);
+    VIEW_RECORD_VIEW(_first, other.size(), Extent == dynamic_extent);
   }
 
   contiguous_view& operator=(const contiguous_view& other) noexcept = default;
@@ -117,6 +122,7 @@ public:
   }
 
   reference operator[](size_t idx) const {
+    VIEW_RECORD_ACCESS(_first, idx, sizeof(T), idx < size());
     runtime_assert(idx < size(), "fefe");
     return *(_first + idx);
   }
@@ -131,63 +137,70 @@ public:
     return *(_first + size() - 1);
   }
 
-  contiguous_view<T, dynamic_extent> subview(size_t offset, size_t count = dynamic_extent) const {
+  contiguous_view<T, dynamic_extent> subview(size_t offset, size_t count = dynamic_extent VIEW_SITE_PARAM) const {
+    VIEW_RECORD(subview);
     if (count == dynamic_extent) {
-      runtime_assert(offset <= size(), "Offset < size.");
-      return contiguous_view<T, dynamic_extent>(_first + offset, _first + size());
+      runtime_assert(offset <= size(), "Offset < size." VIEW_SITE_ARG);
+      return contiguous_view<T, dynamic_extent>(_first + offset, _first + size() VIEW_SITE_ARG);
     } else {
-      runtime_assert(offset + count <= size(), "Size + Offset must be lower or equals than size.");
-      return contiguous_view<T, dynamic_extent>(_first + offset, _first + offset + count);
+      runtime_assert(offset + count <= size(), "Size + Offset must be lower or equals than size." VIEW_SITE_ARG);
+      return contiguous_view<T, dynamic_extent>(_first + offset, _first + offset + count VIEW_SITE_ARG);
     }
   }
 
   template <size_t Offset, size_t Count = dynamic_extent>
-  auto subview() const {
+  auto subview(VIEW_SITE_ONLY_PARAM) const {
     static_assert(Offset <= Extent);
     static_assert(Count == dynamic_extent || Count <= Extent - Offset);
+    VIEW_RECORD(subview);
     if constexpr (Count == dynamic_extent) {
-      runtime_assert(Offset <= size(), "Offset < size.");
+      runtime_assert(Offset <= size(), "Offset < size." VIEW_SITE_ARG);
       if constexpr (Extent == dynamic_extent) {
-        return contiguous_view<T, dynamic_extent>(_first + Offset, _first + size());
+        return contiguous_view<T, dynamic_extent>(_first + Offset, _first + size() VIEW_SITE_ARG);
       } else {
-        return contiguous_view<T, Extent - Offset>(_first + Offset, end());
+        return contiguous_view<T, Extent - Offset>(_first + Offset, end() VIEW_SITE_ARG);
       }
     } else {
-      runtime_assert(Offset + Count <= size(), "Size And Offset must be lower");
-      return contiguous_view<T, Count>(_first + Offset, Count);
+      runtime_assert(Offset + Count <= size(), "Size And Offset must be lower" VIEW_SITE_ARG);
+      return contiguous_view<T, Count>(_first + Offset, Count VIEW_SITE_ARG);
     }
   }
 
   template <size_t Count>
-  contiguous_view<T, Count> first() const {
+  contiguous_view<T, Count> first(VIEW_SITE_ONLY_PARAM) const {
     static_assert(Count <= Extent);
-    runtime_assert(Count <= size(), "");
-    return contiguous_view<T, Count>(begin(), Count);
+    VIEW_RECORD(first);
+    runtime_assert(Count <= size(), "" VIEW_SITE_ARG);
+    return contiguous_view<T, Count>(begin(), Count VIEW_SITE_ARG);
   }
 
-  contiguous_view<T, dynamic_extent> first(size_t count) const {
-    runtime_assert(count <= size(), "y");
-    return contiguous_view<T, dynamic_extent>(begin(), count);
+  contiguous_view<T, dynamic_extent> first(size_t count VIEW_SITE_PARAM) const {
+    VIEW_RECORD(first);
+    runtime_assert(count <= size(), "y" VIEW_SITE_ARG);
+    return contiguous_view<T, dynamic_extent>(begin(), count VIEW_SITE_ARG);
   }
 
-  contiguous_view<T, dynamic_extent> last(size_t count) const {
-    runtime_assert(count <= size(), "");
-    return contiguous_view<T, dynamic_extent>(begin() + size() - count, count);
+  contiguous_view<T, dynamic_extent> last(size_t count VIEW_SITE_PARAM) const {
+    VIEW_RECORD(last);
+    runtime_assert(count <= size(), "" VIEW_SITE_ARG);
+    return contiguous_view<T, dynamic_extent>(begin() + size() - count, count VIEW_SITE_ARG);
   }
 
   template <size_t Count>
-  contiguous_view<T, Count> last() const {
+  contiguous_view<T, Count> last(VIEW_SITE_ONLY_PARAM) const {
     static_assert(Count <= Extent);
-    runtime_assert(Count <= size(), "");
-    return contiguous_view<T, Count>(begin() + size() - Count, Count);
+    VIEW_RECORD(last);
+    runtime_assert(Count <= size(), "" VIEW_SITE_ARG);
+    return contiguous_view<T, Count>(begin() + size() - Count, Count VIEW_SITE_ARG);
   }
 
   inline static constexpr size_t fun = (Extent != dynamic_extent) ? (Extent * sizeof(T)) : dynamic_extent;
 
   using byte = std::conditional_t<std::is_const_v<T>, const std::byte, std::byte>;
 
-  contiguous_view<byte, fun> as_bytes() const {
-    return contiguous_view<byte, fun>(reinterpret_cast<byte*>(begin()), size_bytes());
+  contiguous_view<byte, fun> as_bytes(VIEW_SITE_ONLY_PARAM) const {
+    VIEW_RECORD(as_bytes);
+    return contiguous_view<byte, fun>(reinterpret_cast<byte*>(begin()), size_bytes() VIEW_SITE_ARG);
   }
 
   explicit operator std::string_view() const
@@ -196,3 +209,5 @@ public:
     return std::string_view(reinterpret_cast<const char*>(begin()), static_cast<std::size_t>(size()));
   }
 };
+
+using char_view = contiguous_view<const char>;
@@ -0,0 +1,296 @@
+#pragma once
+
+#include "contiguous-view.h"
+#include "view-copy.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define GATHER_HAS_X86_DISPATCH 1
+#endif
+
+struct gather_options {
+  // How many indices ahead to prefetch the element that will be loaded.
+  size_t prefetch_distance = 16;
+  // Set when the indices are non-decreasing: they are then processed in
+  // cache-sized blocks of the indexed view (see `sorted_segments`), without
+  // per-element prefetches, and validation only needs the last index of each
+  // block.
+  bool sorted_indices = false;
+};
+
+namespace gather_detail {
+
+inline constexpr size_t batch_size = 256;
+// Elements gathered between two rounds of prefetches: one AVX2 gather of
+// 4-byte elements.
+inline constexpr size_t step_size = 8;
+// Window of the indexed view that one block of sorted indices may touch: half
+// of a typical L1 data cache.
+inline constexpr size_t block_bytes = 16 * 1024;
+
+template <typename T>
+inline constexpr size_t block_elements = std::max<size_t>(1, block_bytes / sizeof(T));
+
+// Hardware gathers and scatters take signed 32-bit indices.
+inline constexpr size_t max_vector_index = INT32_MAX;
+
+template <typename T>
+void prefetch(const T* p) {
+#if defined(__GNUC__)
+  __builtin_prefetch(p);
+#else
+  static_cast<void>(p);
+#endif
+}
+
+// Checks a whole batch with one branch; the max reduction vectorizes. Only
+// done in debug builds, release builds trust the indices.
+inline void validate(const std::uint32_t* idx, size_t count, size_t limit, bool sorted) {
+#ifndef NDEBUG
+  if (count == 0) {
+    return;
+  }
+  std::uint32_t max = sorted ? idx[count - 1] : *std::max_element(idx, idx + count);
+  runtime_assert(max < limit, "Index out of range.");
+#else
+  static_cast<void>(idx);
+  static_cast<void>(count);
+  static_cast<void>(limit);
+  static_cast<void>(sorted);
+#endif
+}
+
+#ifdef GATHER_HAS_X86_DISPATCH
+
+template <typename T>
+__attribute__((target("avx2"))) size_t gather_avx2(const T* in, const std::uint32_t* idx, T* out, size_t count) {
+  size_t i = 0;
+  if constexpr (sizeof(T) == 4) {
+    for (; i + 8 <= count; i += 8) {
+      __m256i vidx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      __m256i v = _mm256_i32gather_epi32(reinterpret_cast<const int*>(in), vidx, 4);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+  } else {
+    for (; i + 4 <= count; i += 4) {
+      __m128i vidx = _mm_loadu_si128(reinterpret_cast<const __m128i*>(idx + i));
+      __m256i v = _mm256_i32gather_epi64(reinterpret_cast<const long long*>(in), vidx, 8);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + i), v);
+    }
+  }
+  return i;
+}
+
+template <typename T>
+__attribute__((target("avx512f"))) size_t scatter_avx512(const T* in, const std::uint32_t* idx, T* out,
+                                                          size_t count) {
+  size_t i = 0;
+  if constexpr (sizeof(T) == 4) {
+    for (; i + 16 <= count; i += 16) {
+      __m512i vidx = _mm512_loadu_si512(idx + i);
+      _mm512_i32scatter_epi32(out, vidx, _mm512_loadu_si512(in + i), 4);
+    }
+  } else {
+    for (; i + 8 <= count; i += 8) {
+      __m256i vidx = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(idx + i));
+      _mm512_i32scatter_epi64(out, vidx, _mm512_loadu_si512(in + i), 8);
+    }
+  }
+  return i;
+}
+
+inline bool has_avx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+
+inline bool has_avx512f() {
+  static const bool supported = __builtin_cpu_supports("avx512f");
+  return supported;
+}
+
+#endif
+
+// Gathers `count` elements with hardware gathers where the CPU has them and
+// returns how many were handled; the caller finishes the rest with scalar
+// code. Only called when the indexed view has at most `max_vector_index`
+// elements.
+template <typename T>
+size_t gather_vector(const T* in, const std::uint32_t* idx, T* out, size_t count) {
+#ifdef GATHER_HAS_X86_DISPATCH
+  if constexpr ((sizeof(T) == 4 || sizeof(T) == 8) && std::is_trivially_copyable_v<T>) {
+    if (has_avx2()) {
+      return gather_avx2(in, idx, out, count);
+    }
+  }
+#endif
+  static_cast<void>(in);
+  static_cast<void>(idx);
+  static_cast<void>(out);
+  static_cast<void>(count);
+  return 0;
+}
+
+template <typename T>
+size_t scatter_vector(const T* in, const std::uint32_t* idx, T* out, size_t count) {
+#ifdef GATHER_HAS_X86_DISPATCH
+  if constexpr ((sizeof(T) == 4 || sizeof(T) == 8) && std::is_trivially_copyable_v<T>) {
+    if (has_avx512f()) {
+      return scatter_avx512(in, idx, out, count);
+    }
+  }
+#endif
+  static_cast<void>(in);
+  static_cast<void>(idx);
+  static_cast<void>(out);
+  static_cast<void>(count);
+  return 0;
+}
+
+// First position in [from, n) whose index is at least `bound`, given that
+// ids[from] is below it. Gallops first, so short segments cost O(1).
+inline size_t sorted_bound(const std::uint32_t* ids, size_t from, size_t n, size_t bound) {
+  size_t lo = from;
+  size_t hi = from + 1;
+  for (size_t step = 1; hi < n && ids[hi] < bound; step *= 2) {
+    lo = hi;
+    hi = std::min(n, lo + step);
+  }
+  return static_cast<size_t>(std::lower_bound(ids + lo, ids + std::min(hi, n), bound) - ids);
+}
+
+// Splits sorted indices into segments that each stay inside one
+// `block`-element window of the indexed view, so a segment's working set fits
+// in L1, and calls `segment(begin, end, dense)`. A dense segment holds
+// consecutive indices and can be copied as one run.
+template <typename Segment>
+void sorted_segments(const std::uint32_t* ids, size_t n, size_t block, Segment segment) {
+  for (size_t begin = 0; begin < n;) {
+    size_t window_end = (size_t{ids[begin]} / block + 1) * block;
+    size_t end = sorted_bound(ids, begin, n, window_end);
+    bool dense = std::adjacent_find(ids + begin, ids + end, [](std::uint32_t a, std::uint32_t b) {
+                   return b != a + 1;
+                 }) == ids + end;
+    segment(begin, end, dense);
+    begin = end;
+  }
+}
+
+} // namespace gather_detail
+
+// out[i] = in[idx[i]]
+template <typename T, size_t N, size_t M, size_t K>
+void gather(
+    contiguous_view<const T, N> in,
+    contiguous_view<const std::uint32_t, M> idx,
+    contiguous_view<T, K> out,
+    gather_options options = {}
+) {
+  runtime_assert(out.size() == idx.size(), "Output size must match index count.");
+  const T* src = in.data();
+  const std::uint32_t* ids = idx.data();
+  T* dst = out.data();
+  size_t n = idx.size();
+  bool vector = in.size() <= gather_detail::max_vector_index;
+
+  if (options.sorted_indices) {
+    gather_detail::sorted_segments(ids, n, gather_detail::block_elements<T>, [&](size_t begin, size_t end, bool dense) {
+      gather_detail::validate(ids + begin, end - begin, in.size(), true);
+      if (end < n) {
+        gather_detail::prefetch(src + ids[end]);
+      }
+      if (dense) {
+        std::copy_n(src + ids[begin], end - begin, dst + begin);
+        return;
+      }
+      size_t i = begin + (vector ? gather_detail::gather_vector(src, ids + begin, dst + begin, end - begin) : 0);
+      for (; i < end; ++i) {
+        dst[i] = src[ids[i]];
+      }
+    });
+    return;
+  }
+
+  for (size_t begin = 0; begin < n; begin += gather_detail::batch_size) {
+    size_t end = std::min(n, begin + gather_detail::batch_size);
+    gather_detail::validate(ids + begin, end - begin, in.size(), false);
+
+    bool prefetch = options.prefetch_distance > 0;
+    for (size_t i = begin; i < end;) {
+      size_t step_end = std::min(end, i + gather_detail::step_size);
+      for (size_t j = i; prefetch && j < step_end && j + options.prefetch_distance < n; ++j) {
+        gather_detail::prefetch(src + ids[j + options.prefetch_distance]);
+      }
+      i += vector ? gather_detail::gather_vector(src, ids + i, dst + i, step_end - i) : 0;
+      for (; i < step_end; ++i) {
+        dst[i] = src[ids[i]];
+      }
+    }
+  }
+}
+
+// out[idx[i]] = in[i]
+template <typename T, size_t N, size_t M, size_t K>
+void scatter(
+    contiguous_view<const T, N> in,
+    contiguous_view<const std::uint32_t, M> idx,
+    contiguous_view<T, K> out,
+    gather_options options = {}
+) {
+  runtime_assert(in.size() == idx.size(), "Input size must match index count.");
+  const T* src = in.data();
+  const std::uint32_t* ids = idx.data();
+  T* dst = out.data();
+  size_t n = idx.size();
+  bool vector = out.size() <= gather_detail::max_vector_index;
+
+  if (options.sorted_indices) {
+    gather_detail::sorted_segments(ids, n, gather_detail::block_elements<T>, [&](size_t begin, size_t end, bool dense) {
+      gather_detail::validate(ids + begin, end - begin, out.size(), true);
+      if (dense) {
+        std::copy_n(src + begin, end - begin, dst + ids[begin]);
+        return;
+      }
+      size_t i = begin + (vector ? gather_detail::scatter_vector(src + begin, ids + begin, dst, end - begin) : 0);
+      for (; i < end; ++i) {
+        dst[ids[i]] = src[i];
+      }
+    });
+    return;
+  }
+
+  for (size_t begin = 0; begin < n; begin += gather_detail::batch_size) {
+    size_t end = std::min(n, begin + gather_detail::batch_size);
+    gather_detail::validate(ids + begin, end - begin, out.size(), false);
+
+    size_t i = begin + (vector ? gather_detail::scatter_vector(src + begin, ids + begin, dst, end - begin) : 0);
+    for (; i < end; ++i) {
+      if (i + options.prefetch_distance < n) {
+        gather_detail::prefetch(dst + ids[i + options.prefetch_distance]);
+      }
+      dst[ids[i]] = src[i];
+    }
+  }
+}
+
+// data[i] = old data[perm[i]], using `scratch` (at least as large as `data`)
+// to hold the gathered result before it is copied back.
+template <typename T, size_t N, size_t M, size_t K>
+void apply_permutation(
+    contiguous_view<T, N> data,
+    contiguous_view<const std::uint32_t, M> perm,
+    contiguous_view<T, K> scratch,
+    gather_options options = {}
+) {
+  static_assert(!std::is_const_v<T>, "Permuted view must be mutable");
+  runtime_assert(perm.size() == data.size(), "Permutation size must match data size.");
+  runtime_assert(scratch.size() >= data.size(), "Scratch view is smaller than data view.");
+  auto gathered = scratch.first(data.size());
+  gather(contiguous_view<const T, N>(data), perm, gathered, options);
+  copy_into(contiguous_view<const T>(gathered), data);
+}
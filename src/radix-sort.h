@@ -0,0 +1,197 @@
+#pragma once
+
+#include "contiguous-view.h"
+#include "topology.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace radix_detail {
+
+inline constexpr size_t digit_bits = 8;
+inline constexpr size_t buckets = size_t(1) << digit_bits;
+
+using histogram = std::array<size_t, buckets>;
+
+// Maps a key to an unsigned integer with the same ordering: signed integers
+// get their sign bit flipped, floats additionally get all other bits flipped
+// when negative.
+template <typename K>
+auto ordered_bits(K key) {
+  if constexpr (std::is_same_v<K, bool>) {
+    return static_cast<std::uint8_t>(key);
+  } else if constexpr (std::is_integral_v<K> && std::is_unsigned_v<K>) {
+    return key;
+  } else if constexpr (std::is_integral_v<K>) {
+    using U = std::make_unsigned_t<K>;
+    return static_cast<U>(static_cast<U>(key) ^ (U(1) << (std::numeric_limits<U>::digits - 1)));
+  } else {
+    static_assert(std::is_floating_point_v<K> && std::numeric_limits<K>::is_iec559, "Unsupported radix key");
+    using U = std::conditional_t<sizeof(K) == 4, std::uint32_t, std::uint64_t>;
+    static_assert(sizeof(K) == sizeof(U));
+    U bits = std::bit_cast<U>(key);
+    U sign = U(1) << (std::numeric_limits<U>::digits - 1);
+    return static_cast<U>(bits & sign ? ~bits : bits | sign);
+  }
+}
+
+template <typename T, typename KeyFn>
+using bits_t = decltype(ordered_bits(std::declval<KeyFn&>()(std::declval<const T&>())));
+
+template <typename Bits>
+size_t digit(Bits bits, size_t pass) {
+  return static_cast<size_t>(bits >> (pass * digit_bits)) & (buckets - 1);
+}
+
+// Counts every digit of every key in one sweep over the input, so each
+// later pass only reads its own histogram.
+template <typename T, typename KeyFn, size_t Passes>
+void count_digits(const T* first, const T* last, KeyFn& key, std::array<histogram, Passes>& counts) {
+  for (; first != last; ++first) {
+    auto bits = ordered_bits(key(*first));
+    for (size_t pass = 0; pass < Passes; ++pass) {
+      ++counts[pass][digit(bits, pass)];
+    }
+  }
+}
+
+// A pass whose digit is the same for every key would only copy.
+inline bool trivial_pass(const histogram& h, size_t n) {
+  return std::any_of(h.begin(), h.end(), [n](size_t c) { return c == n; });
+}
+
+template <typename T, typename KeyFn>
+void scatter(T* first, T* last, T* out, KeyFn& key, size_t pass, histogram& offsets) {
+  for (; first != last; ++first) {
+    size_t d = digit(ordered_bits(key(*first)), pass);
+    out[offsets[d]++] = std::move(*first);
+  }
+}
+
+template <typename T, typename KeyFn>
+void lsd_sort(T* data, T* scratch, size_t n, KeyFn key, size_t threads) {
+  using bits = bits_t<T, KeyFn>;
+  constexpr size_t passes = sizeof(bits);
+  threads = std::max<size_t>(1, std::min(threads, n / buckets));
+
+  std::vector<std::array<histogram, passes>> counts(threads, std::array<histogram, passes>{});
+  auto chunk_begin = [n, threads](size_t t) {
+    return n * t / threads;
+  };
+  auto parallel = [threads](auto&& fn) {
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) {
+      workers.emplace_back(fn, t);
+    }
+    fn(0);
+    for (auto& w : workers) {
+      w.join();
+    }
+  };
+
+  parallel([&](size_t t) { count_digits(data + chunk_begin(t), data + chunk_begin(t + 1), key, counts[t]); });
+
+  T* src = data;
+  T* dst = scratch;
+  bool moved = false;
+  std::vector<histogram> offsets(threads);
+  for (size_t pass = 0; pass < passes; ++pass) {
+    histogram total{};
+    for (size_t t = 0; t < threads; ++t) {
+      for (size_t d = 0; d < buckets; ++d) {
+        total[d] += counts[t][pass][d];
+      }
+    }
+    if (trivial_pass(total, n)) {
+      continue;
+    }
+
+    // The totals do not depend on the order of the elements, but the
+    // per-chunk counts do, so they are redone once a pass has moved data.
+    if (threads > 1 && moved) {
+      parallel([&](size_t t) {
+        counts[t][pass] = {};
+        for (const T* it = src + chunk_begin(t); it != src + chunk_begin(t + 1); ++it) {
+          ++counts[t][pass][digit(ordered_bits(key(*it)), pass)];
+        }
+      });
+    }
+
+    // Thread t writes bucket d right after what threads [0, t) put there,
+    // which keeps the sort stable.
+    size_t sum = 0;
+    for (size_t d = 0; d < buckets; ++d) {
+      for (size_t t = 0; t < threads; ++t) {
+        offsets[t][d] = sum;
+        sum += counts[t][pass][d];
+      }
+    }
+
+    parallel([&](size_t t) { scatter(src + chunk_begin(t), src + chunk_begin(t + 1), dst, key, pass, offsets[t]); });
+    std::swap(src, dst);
+    moved = true;
+  }
+
+  if (src != data) {
+    std::move(src, src + n, data);
+  }
+}
+
+struct identity_key {
+  template <typename T>
+  const T& operator()(const T& x) const {
+    return x;
+  }
+};
+
+inline size_t llc_bytes() {
+  static const size_t bytes = read_cpu_topology().llc_bytes;
+  return bytes;
+}
+
+} // namespace radix_detail
+
+// Stable LSD radix sort on 8-bit digits of `key(element)`, which may be any
+// integral or IEEE floating-point type. `scratch` must be at least as large
+// as `data`; its contents are clobbered. Digits shared by all keys are
+// skipped, so small key ranges cost fewer passes.
+template <typename T, size_t Extent, size_t ScratchExtent, typename KeyFn>
+void radix_sort(contiguous_view<T, Extent> data, contiguous_view<T, ScratchExtent> scratch, KeyFn key) {
+  static_assert(!std::is_const_v<T>, "Sorted view must be mutable");
+  if constexpr (Extent != dynamic_extent && ScratchExtent != dynamic_extent) {
+    static_assert(ScratchExtent >= Extent, "Scratch view is smaller than data view");
+  }
+  runtime_assert(scratch.size() >= data.size(), "Scratch view is smaller than data view.");
+  radix_detail::lsd_sort(data.data(), scratch.data(), data.size(), std::move(key), 1);
+}
+
+template <typename T, size_t Extent, size_t ScratchExtent>
+void radix_sort(contiguous_view<T, Extent> data, contiguous_view<T, ScratchExtent> scratch) {
+  radix_sort(data, scratch, radix_detail::identity_key{});
+}
+
+// Same as `radix_sort`, but views that do not fit into the last-level cache
+// are counted and scattered by `threads` workers, each owning a contiguous
+// chunk of the input.
+template <typename T, size_t Extent, size_t ScratchExtent, typename KeyFn = radix_detail::identity_key>
+void parallel_radix_sort(
+    contiguous_view<T, Extent> data,
+    contiguous_view<T, ScratchExtent> scratch,
+    KeyFn key = {},
+    size_t threads = std::thread::hardware_concurrency()
+) {
+  static_assert(!std::is_const_v<T>, "Sorted view must be mutable");
+  runtime_assert(scratch.size() >= data.size(), "Scratch view is smaller than data view.");
+  if (data.size_bytes() < radix_detail::llc_bytes()) {
+    threads = 1;
+  }
+  radix_detail::lsd_sort(data.data(), scratch.data(), data.size(), std::move(key), threads);
+}
@@ -1,7 +1,27 @@
 #include "runtime-assert.h"
 
+#ifdef CONTIGUOUS_VIEW_INSTRUMENTATION
+#include "view-instrumentation.h"
+
+void runtime_assert(bool condition, const std::string& message, std::source_location site) {
+  if (!condition) {
+    view_instrumentation::record_assert_failure(site);
+    throw assertion_error(message);
+  }
+}
+
+void runtime_assert_failed(const char* message, std::source_location site) {
+  view_instrumentation::record_assert_failure(site);
+  throw assertion_error(message);
+}
+#else
 void runtime_assert(bool condition, const std::string& message) {
   if (!condition) {
     throw assertion_error(message);
   }
 }
+
+void runtime_assert_failed(const char* message) {
+  throw assertion_error(message);
+}
+#endif
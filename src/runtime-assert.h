@@ -5,4 +5,37 @@ struct assertion_error : std::runtime_error {
   using std::runtime_error::runtime_error;
 };
 
+// The `const char*` overloads are inline and only leave the caller on failure,
+// so checks with literal messages cost one branch and no std::string.
+#ifdef CONTIGUOUS_VIEW_INSTRUMENTATION
+#include <source_location>
+
+// Failures are counted against `site`; see view-instrumentation.h.
+void runtime_assert(
+    bool condition,
+    const std::string& message,
+    std::source_location site = std::source_location::current()
+);
+
+[[noreturn]] void runtime_assert_failed(const char* message, std::source_location site);
+
+inline void runtime_assert(
+    bool condition,
+    const char* message,
+    std::source_location site = std::source_location::current()
+) {
+  if (!condition) [[unlikely]] {
+    runtime_assert_failed(message, site);
+  }
+}
+#else
 void runtime_assert(bool condition, const std::string& message);
+
+[[noreturn]] void runtime_assert_failed(const char* message);
+
+inline void runtime_assert(bool condition, const char* message) {
+  if (!condition) [[unlikely]] {
+    runtime_assert_failed(message);
+  }
+}
+#endif
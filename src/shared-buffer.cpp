@@ -0,0 +1,88 @@
+#include "shared-buffer.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+size_t size_class(size_t bytes) {
+  return static_cast<size_t>(std::bit_width(std::max(bytes, buffer_pool::min_block_size) - 1));
+}
+
+} // namespace
+
+buffer_pool::buffer_pool(size_t max_cached_per_class)
+    : _max_cached_per_class(max_cached_per_class) {}
+
+buffer_pool::~buffer_pool() {
+  for (free_block* head : _free) {
+    while (head) {
+      free_block* next = head->next;
+      ::operator delete(static_cast<void*>(head), std::align_val_t{cache_line_size});
+      head = next;
+    }
+  }
+}
+
+void* buffer_pool::acquire(size_t bytes, size_t& block_size) {
+  size_t cls = size_class(bytes);
+  runtime_assert(cls < classes, "Block size is too large.");
+  block_size = size_t{1} << cls;
+  {
+    std::lock_guard lock(_mutex);
+    if (free_block* head = _free[cls]) {
+      _free[cls] = head->next;
+      --_cached[cls];
+      return head;
+    }
+    ++_heap_allocations;
+  }
+  return ::operator new(block_size, std::align_val_t{cache_line_size});
+}
+
+void buffer_pool::release(void* block, size_t block_size) noexcept {
+  size_t cls = size_class(block_size);
+  {
+    std::lock_guard lock(_mutex);
+    if (_cached[cls] < _max_cached_per_class) {
+      _free[cls] = ::new (block) free_block{_free[cls]};
+      ++_cached[cls];
+      return;
+    }
+  }
+  ::operator delete(block, std::align_val_t{cache_line_size});
+}
+
+size_t buffer_pool::cached_blocks() const {
+  std::lock_guard lock(_mutex);
+  size_t total = 0;
+  for (size_t count : _cached) {
+    total += count;
+  }
+  return total;
+}
+
+size_t buffer_pool::heap_allocations() const {
+  std::lock_guard lock(_mutex);
+  return _heap_allocations;
+}
+
+namespace shared_buffer_detail {
+
+void* allocate_block(size_t bytes, buffer_pool* pool, size_t& block_size) {
+  if (pool) {
+    return pool->acquire(bytes, block_size);
+  }
+  block_size = bytes;
+  return ::operator new(bytes, std::align_val_t{cache_line_size});
+}
+
+void release_block(void* block, buffer_pool* pool, size_t block_size) noexcept {
+  if (pool) {
+    pool->release(block, block_size);
+  } else {
+    ::operator delete(block, std::align_val_t{cache_line_size});
+  }
+}
+
+} // namespace shared_buffer_detail
@@ -0,0 +1,259 @@
+#pragma once
+
+#include "atomic-view.h"
+#include "contiguous-view.h"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Recycles raw blocks in power-of-two size classes. Freed blocks are kept on
+// an intrusive per-class list (the link lives in the block itself), so once
+// traffic reaches steady state acquire and release never touch the heap.
+// The pool must outlive every buffer allocated from it.
+class buffer_pool {
+public:
+  inline static constexpr size_t min_block_size = 2 * cache_line_size;
+
+  explicit buffer_pool(size_t max_cached_per_class = 64);
+  ~buffer_pool();
+
+  buffer_pool(const buffer_pool&) = delete;
+  buffer_pool& operator=(const buffer_pool&) = delete;
+
+  // Returns a cache-line aligned block of at least `bytes` bytes; its actual
+  // size is stored in `block_size`.
+  void* acquire(size_t bytes, size_t& block_size);
+  void release(void* block, size_t block_size) noexcept;
+
+  // Blocks currently cached, and blocks ever obtained from the heap.
+  size_t cached_blocks() const;
+  size_t heap_allocations() const;
+
+private:
+  struct free_block {
+    free_block* next;
+  };
+
+  inline static constexpr size_t classes = 64;
+
+  mutable std::mutex _mutex;
+  std::array<free_block*, classes> _free{};
+  std::array<size_t, classes> _cached{};
+  size_t _max_cached_per_class;
+  size_t _heap_allocations = 0;
+};
+
+namespace shared_buffer_detail {
+
+// Sits in its own cache line in front of the elements, so refcount traffic
+// does not false-share with the data.
+template <bool Atomic>
+struct control_block {
+  std::conditional_t<Atomic, std::atomic<size_t>, size_t> refs;
+  buffer_pool* pool;
+  size_t block_size;
+
+  void add_ref() noexcept {
+    if constexpr (Atomic) {
+      refs.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      ++refs;
+    }
+  }
+
+  // Returns true when this was the last reference.
+  bool drop_ref() noexcept {
+    if constexpr (Atomic) {
+      return refs.fetch_sub(1, std::memory_order_acq_rel) == 1;
+    } else {
+      return --refs == 0;
+    }
+  }
+
+  size_t use_count() const noexcept {
+    if constexpr (Atomic) {
+      return refs.load(std::memory_order_relaxed);
+    } else {
+      return refs;
+    }
+  }
+};
+
+inline constexpr size_t data_offset = cache_line_size;
+
+// Out of line: the cold path, and it keeps the heap calls out of sight of
+// GCC's use-after-free analysis of the inlined refcount.
+void* allocate_block(size_t bytes, buffer_pool* pool, size_t& block_size);
+void release_block(void* block, buffer_pool* pool, size_t block_size) noexcept;
+
+template <bool Atomic>
+control_block<Atomic>* create(size_t count, size_t element_size, buffer_pool* pool) {
+  runtime_assert(count <= (SIZE_MAX - data_offset) / element_size, "Buffer size overflows size_t.");
+  size_t block_size;
+  void* block = allocate_block(data_offset + count * element_size, pool, block_size);
+  return ::new (block) control_block<Atomic>{{1}, pool, block_size};
+}
+
+template <bool Atomic>
+void destroy(control_block<Atomic>* control) noexcept {
+  buffer_pool* pool = control->pool;
+  size_t block_size = control->block_size;
+  control->~control_block();
+  release_block(control, pool, block_size);
+}
+
+} // namespace shared_buffer_detail
+
+// Owning, reference-counted handle to a range of elements. Copies and slices
+// share one allocation and cost a refcount increment; the allocation goes
+// back to the heap or to its pool when the last handle is dropped. With
+// `Atomic = false` the refcount is a plain integer, for buffers that never
+// cross threads.
+template <typename T, bool Atomic = true>
+class shared_buffer {
+  static_assert(std::is_trivially_copyable_v<T>, "shared_buffer requires trivially copyable elements");
+  static_assert(alignof(T) <= cache_line_size);
+
+  using control = shared_buffer_detail::control_block<Atomic>;
+
+  template <typename U, bool A>
+  friend class shared_buffer;
+
+public:
+  using element_type = T;
+  using view_type = contiguous_view<T>;
+
+  shared_buffer() noexcept = default;
+
+  // Element values of a fresh buffer are unspecified.
+  static shared_buffer allocate(size_t count) {
+    return shared_buffer(shared_buffer_detail::create<Atomic>(count, sizeof(T), nullptr), count);
+  }
+
+  static shared_buffer allocate(size_t count, buffer_pool& pool) {
+    return shared_buffer(shared_buffer_detail::create<Atomic>(count, sizeof(T), &pool), count);
+  }
+
+  shared_buffer(const shared_buffer& other) noexcept
+      : _control(other._control)
+      , _data(other._data)
+      , _size(other._size) {
+    if (_control) {
+      _control->add_ref();
+    }
+  }
+
+  shared_buffer(shared_buffer&& other) noexcept
+      : _control(std::exchange(other._control, nullptr))
+      , _data(std::exchange(other._data, nullptr))
+      , _size(std::exchange(other._size, 0)) {}
+
+  // Read-only handle from a mutable one.
+  template <typename U>
+    requires (std::is_same_v<const U, T> && !std::is_same_v<U, T>)
+  shared_buffer(shared_buffer<U, Atomic> other) noexcept
+      : _control(std::exchange(other._control, nullptr))
+      , _data(std::exchange(other._data, nullptr))
+      , _size(std::exchange(other._size, 0)) {}
+
+  shared_buffer& operator=(shared_buffer other) noexcept {
+    swap(other);
+    return *this;
+  }
+
+  ~shared_buffer() {
+    reset();
+  }
+
+  void swap(shared_buffer& other) noexcept {
+    std::swap(_control, other._control);
+    std::swap(_data, other._data);
+    std::swap(_size, other._size);
+  }
+
+  void reset() noexcept {
+    if (_control && _control->drop_ref()) {
+      shared_buffer_detail::destroy(_control);
+    }
+    _control = nullptr;
+    _data = nullptr;
+    _size = 0;
+  }
+
+  // Handle to `count` elements starting at `offset`, sharing this allocation.
+  shared_buffer slice(size_t offset, size_t count = dynamic_extent) const {
+    view_type part = view().subview(offset, count);
+    shared_buffer result(*this);
+    result._data = part.data();
+    result._size = part.size();
+    return result;
+  }
+
+  view_type view() const noexcept {
+    return view_type(_data, _size);
+  }
+
+  operator view_type() const noexcept {
+    return view();
+  }
+
+  view_type subview(size_t offset, size_t count = dynamic_extent) const {
+    return view().subview(offset, count);
+  }
+
+  view_type first(size_t count) const {
+    return view().first(count);
+  }
+
+  view_type last(size_t count) const {
+    return view().last(count);
+  }
+
+  T* data() const noexcept {
+    return _data;
+  }
+
+  size_t size() const noexcept {
+    return _size;
+  }
+
+  bool empty() const noexcept {
+    return _size == 0;
+  }
+
+  T& operator[](size_t idx) const {
+    return view()[idx];
+  }
+
+  T* begin() const noexcept {
+    return _data;
+  }
+
+  T* end() const noexcept {
+    return _data + _size;
+  }
+
+  // Handles sharing the allocation, including this one; 0 when empty.
+  size_t use_count() const noexcept {
+    return _control ? _control->use_count() : 0;
+  }
+
+private:
+  shared_buffer(control* block, size_t count) noexcept
+      : _control(block)
+      , _data(reinterpret_cast<T*>(reinterpret_cast<std::byte*>(block) + shared_buffer_detail::data_offset))
+      , _size(count) {}
+
+  control* _control = nullptr;
+  T* _data = nullptr;
+  size_t _size = 0;
+};
+
+template <typename T>
+using local_shared_buffer = shared_buffer<T, false>;
@@ -0,0 +1,249 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <type_traits>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <immintrin.h>
+#define SORTED_SEARCH_HAS_X86_DISPATCH 1
+#endif
+
+namespace sorted_search_detail {
+
+inline constexpr size_t cache_line = 64;
+
+#ifdef SORTED_SEARCH_HAS_X86_DISPATCH
+inline bool has_avx2() {
+  static const bool supported = __builtin_cpu_supports("avx2");
+  return supported;
+}
+#endif
+
+template <typename T>
+void prefetch(const T* p) {
+#if defined(__GNUC__)
+  __builtin_prefetch(p);
+#else
+  static_cast<void>(p);
+#endif
+}
+
+// Halves the range with a conditional move instead of a branch; both possible
+// next midpoints are prefetched one iteration ahead.
+template <typename T, typename Less>
+size_t branchless_bound(const T* base, size_t n, Less less) {
+  const T* first = base;
+  if (n == 0) {
+    return 0;
+  }
+  while (n > 1) {
+    size_t half = n / 2;
+    prefetch(base + half / 2);
+    prefetch(base + half + half / 2);
+    base = less(base[half - 1]) ? base + half : base;
+    n -= half;
+  }
+  return static_cast<size_t>(base - first) + (less(*base) ? 1 : 0);
+}
+
+} // namespace sorted_search_detail
+
+// Index of the first element not less than `key`, like `std::lower_bound`.
+template <typename T, size_t Extent>
+size_t branchless_lower_bound(contiguous_view<T, Extent> sorted, const std::remove_const_t<T>& key) {
+  return sorted_search_detail::branchless_bound(sorted.data(), sorted.size(), [&](const auto& x) { return x < key; });
+}
+
+// Index of the first element greater than `key`, like `std::upper_bound`.
+template <typename T, size_t Extent>
+size_t branchless_upper_bound(contiguous_view<T, Extent> sorted, const std::remove_const_t<T>& key) {
+  return sorted_search_detail::branchless_bound(sorted.data(), sorted.size(), [&](const auto& x) {
+    return !(key < x);
+  });
+}
+
+// Sorted keys in BFS order of an implicit binary search tree: the children of
+// node k are 2k and 2k + 1, slot 0 is unused. The top levels share a few cache
+// lines, and the descent is branch-free with the next levels prefetched.
+template <typename T>
+class eytzinger_index {
+  contiguous_view<const T> _layout;
+
+  static size_t fill(contiguous_view<const T> sorted, contiguous_view<T> out, size_t i, size_t k) {
+    if (k < out.size()) {
+      i = fill(sorted, out, i, 2 * k);
+      out[k] = sorted[i++];
+      i = fill(sorted, out, i, 2 * k + 1);
+    }
+    return i;
+  }
+
+public:
+  static constexpr size_t npos = 0;
+
+  static size_t required_size(size_t n) {
+    return n + 1;
+  }
+
+  eytzinger_index() = default;
+
+  explicit eytzinger_index(contiguous_view<const T> layout)
+      : _layout(layout) {
+    runtime_assert(!layout.empty(), "Eytzinger layout has a reserved first slot.");
+  }
+
+  // Writes the layout of `sorted` into `out`, which must hold exactly
+  // `required_size(sorted.size())` elements, and returns an index over it.
+  static eytzinger_index build(contiguous_view<const T> sorted, contiguous_view<T> out) {
+    runtime_assert(out.size() == required_size(sorted.size()), "Output size must be required_size(n).");
+    out[0] = T{};
+    fill(sorted, out, 0, 1);
+    return eytzinger_index(out);
+  }
+
+  size_t size() const noexcept {
+    return _layout.size() - 1;
+  }
+
+  // Layout position of the first key not less than `key`, or `npos`.
+  size_t lower_bound(const T& key) const {
+    const T* layout = _layout.data();
+    size_t n = _layout.size();
+    // Four levels below k start at 16k, which is one cache line away for
+    // 4-byte keys; scale that for other key sizes.
+    constexpr size_t lookahead = std::max<size_t>(1, sorted_search_detail::cache_line / sizeof(T));
+    size_t k = 1;
+    while (k < n) {
+      sorted_search_detail::prefetch(layout + std::min(k * lookahead, n - 1));
+      k = 2 * k + (layout[k] < key ? 1 : 0);
+    }
+    k >>= std::countr_one(k) + 1;
+    return k;
+  }
+
+  const T& operator[](size_t pos) const {
+    runtime_assert(pos != npos && pos < _layout.size(), "Position must point at a key.");
+    return _layout[pos];
+  }
+};
+
+// Implicit static B-tree: every node is one cache line of sorted keys and the
+// children of node k are k * (B + 1) + i + 1. A lookup touches one line per
+// level and ranks the key inside a node with a single vector compare.
+template <typename T>
+class static_btree {
+  static_assert(std::is_integral_v<T>, "static_btree pads nodes with the maximum key");
+
+public:
+  static constexpr size_t node_keys = sorted_search_detail::cache_line / sizeof(T);
+
+private:
+  contiguous_view<const T> _layout;
+  std::optional<T> _max;
+
+  static size_t nodes(size_t n) {
+    return (n + node_keys - 1) / node_keys;
+  }
+
+  static size_t child(size_t k, size_t i) {
+    return k * (node_keys + 1) + i + 1;
+  }
+
+  static size_t fill(contiguous_view<const T> sorted, contiguous_view<T> out, size_t t, size_t k) {
+    if (k < nodes(sorted.size())) {
+      for (size_t i = 0; i < node_keys; ++i) {
+        t = fill(sorted, out, t, child(k, i));
+        out[k * node_keys + i] = t < sorted.size() ? sorted[t++] : std::numeric_limits<T>::max();
+      }
+      t = fill(sorted, out, t, child(k, node_keys));
+    }
+    return t;
+  }
+
+  // Number of keys in `node` that are less than `key`. Fixed trip count over
+  // one line: compilers turn this into a vector compare plus horizontal add.
+  static size_t rank(const T* node, const T& key) {
+    size_t count = 0;
+    for (size_t i = 0; i < node_keys; ++i) {
+      count += node[i] < key ? 1 : 0;
+    }
+    return count;
+  }
+
+  template <size_t (*Rank)(const T*, const T&)>
+  __attribute__((always_inline)) static T descend(const T* layout, size_t n, const T& key, T result) {
+    for (size_t k = 0; k < n;) {
+      size_t i = Rank(layout + k * node_keys, key);
+      if (i < node_keys) {
+        result = layout[k * node_keys + i];
+      }
+      k = child(k, i);
+    }
+    return result;
+  }
+
+#ifdef SORTED_SEARCH_HAS_X86_DISPATCH
+  // Without AVX2 the portable loop only gets SSE2, which has no 64-bit
+  // compare; AVX2 only has signed ones, so flip the sign bit of both sides
+  // for unsigned keys.
+  __attribute__((target("avx2"))) static size_t rank_avx2(const T* node, const T& key) {
+    constexpr long long flip = std::is_signed_v<T> ? 0 : std::numeric_limits<long long>::min();
+    __m256i k = _mm256_set1_epi64x(static_cast<long long>(key) ^ flip);
+    __m256i f = _mm256_set1_epi64x(flip);
+    unsigned mask = 0;
+    for (size_t i = 0; i < node_keys; i += 4) {
+      __m256i v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(node + i)), f);
+      mask |= static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(k, v)))) << i;
+    }
+    return static_cast<size_t>(std::popcount(mask));
+  }
+
+  __attribute__((target("avx2"))) static T descend_avx2(const T* layout, size_t n, const T& key, T result) {
+    return descend<rank_avx2>(layout, n, key, result);
+  }
+#endif
+
+public:
+  static size_t required_size(size_t n) {
+    return nodes(n) * node_keys;
+  }
+
+  static_btree() = default;
+
+  // Writes the tree for `sorted` into `out`, which must hold exactly
+  // `required_size(sorted.size())` elements, and returns an index over it.
+  static static_btree build(contiguous_view<const T> sorted, contiguous_view<T> out) {
+    runtime_assert(out.size() == required_size(sorted.size()), "Output size must be required_size(n).");
+    fill(sorted, out, 0, 0);
+    static_btree result;
+    result._layout = out;
+    if (!sorted.empty()) {
+      result._max = sorted.back();
+    }
+    return result;
+  }
+
+  // Smallest key not less than `key`, if any.
+  std::optional<T> lower_bound(const T& key) const {
+    if (!_max || *_max < key) {
+      return std::nullopt;
+    }
+    const T* layout = _layout.data();
+    size_t n = nodes(_layout.size());
+#ifdef SORTED_SEARCH_HAS_X86_DISPATCH
+    if constexpr (sizeof(T) == 8) {
+      if (sorted_search_detail::has_avx2()) {
+        return descend_avx2(layout, n, key, *_max);
+      }
+    }
+#endif
+    return descend<rank>(layout, n, key, *_max);
+  }
+};
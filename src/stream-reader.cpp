@@ -0,0 +1,183 @@
+#include "stream-reader.h"
+
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <system_error>
+
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+int open_or_throw(const std::string& path) {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+  return fd;
+}
+
+} // namespace
+
+void stream_reader::aligned_delete::operator()(std::byte* p) const {
+  ::operator delete[](p, std::align_val_t{buffer_alignment});
+}
+
+stream_reader::stream_reader(int fd, size_t window_size, size_t buffers, size_t carry_capacity)
+    : stream_reader(fd, false, window_size, buffers, carry_capacity) {}
+
+stream_reader::stream_reader(const std::string& path, size_t window_size, size_t buffers, size_t carry_capacity)
+    : stream_reader(open_or_throw(path), true, window_size, buffers, carry_capacity) {}
+
+// Owns the descriptor from the start, so a failure anywhere in construction
+// closes it.
+stream_reader::stream_reader(int fd, bool owns_fd, size_t window_size, size_t buffers, size_t carry_capacity) try
+    : _fd(fd)
+    , _owns_fd(owns_fd)
+    , _window_size(window_size)
+    , _carry_capacity((carry_capacity + buffer_alignment - 1) / buffer_alignment * buffer_alignment)
+    , _slots(buffers) {
+  runtime_assert(window_size > 0, "Window size must be positive.");
+  runtime_assert(buffers >= 2, "At least two buffers are needed to overlap reads.");
+  for (slot& s : _slots) {
+    s.buffer.reset(new (std::align_val_t{buffer_alignment}) std::byte[_carry_capacity + _window_size]);
+  }
+  // pread ignores the file position, so start from where the caller left it.
+  off_t start = ::lseek(fd, 0, SEEK_CUR);
+  if (start < 0) {
+    _use_pread = false;
+  } else {
+    _offset = static_cast<unsigned long long>(start);
+  }
+  _thread = std::thread([this] { read_loop(); });
+} catch (...) {
+  if (owns_fd) {
+    ::close(fd);
+  }
+}
+
+stream_reader::~stream_reader() {
+  {
+    std::lock_guard lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  _thread.join();
+  if (_owns_fd) {
+    ::close(_fd);
+  } else if (_use_pread) {
+    // Leave a borrowed descriptor where read() would have: after the last
+    // byte fetched.
+    ::lseek(_fd, static_cast<off_t>(_offset), SEEK_SET);
+  }
+}
+
+size_t stream_reader::fill(std::byte* dst) {
+  size_t got = 0;
+  while (got < _window_size) {
+    ssize_t n;
+    if (_use_pread) {
+      n = ::pread(_fd, dst + got, _window_size - got, static_cast<off_t>(_offset));
+      if (n < 0 && errno == ESPIPE) {
+        _use_pread = false;
+        continue;
+      }
+    } else {
+      n = ::read(_fd, dst + got, _window_size - got);
+    }
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(), "stream_reader");
+    }
+    if (n == 0) {
+      break;
+    }
+    got += static_cast<size_t>(n);
+    _offset += static_cast<unsigned long long>(n);
+  }
+  return got;
+}
+
+void stream_reader::read_loop() {
+  for (size_t produced = 0;; ++produced) {
+    slot& s = _slots[produced % _slots.size()];
+    {
+      std::unique_lock lock(_mutex);
+      _cv.wait(lock, [&] { return _stop || s.state == slot_state::free; });
+      if (_stop) {
+        return;
+      }
+    }
+
+    size_t length = 0;
+    std::exception_ptr error;
+    try {
+      length = fill(s.buffer.get() + _carry_capacity);
+    } catch (...) {
+      error = std::current_exception();
+    }
+
+    {
+      std::lock_guard lock(_mutex);
+      if (error) {
+        _error = error;
+      } else {
+        s.length = length;
+        s.state = slot_state::ready;
+        ++_filled;
+        _eof = length < _window_size;
+      }
+    }
+    _cv.notify_all();
+    if (error || length < _window_size) {
+      return;
+    }
+  }
+}
+
+stream_reader::window stream_reader::next() {
+  slot& upcoming = _slots[_consumed % _slots.size()];
+  std::byte* prefix = upcoming.buffer.get() + _carry_capacity - _pending_carry;
+  if (_pending_carry > 0) {
+    // The reader never writes below `_carry_capacity`, so this is race-free
+    // even while `upcoming` is being filled.
+    std::memmove(prefix, _current.end() - _pending_carry, _pending_carry);
+  }
+
+  std::unique_lock lock(_mutex);
+  if (_current_slot != no_slot) {
+    _slots[_current_slot].state = slot_state::free;
+    _current_slot = no_slot;
+    _cv.notify_all();
+  }
+  _cv.wait(lock, [&] { return upcoming.state == slot_state::ready || _error || (_eof && _filled == _consumed); });
+
+  size_t carried = _pending_carry;
+  _pending_carry = 0;
+  if (upcoming.state != slot_state::ready) {
+    if (_error) {
+      std::rethrow_exception(_error);
+    }
+    _current_fresh = 0;
+    _current = window(prefix, carried);
+    return _current;
+  }
+
+  _current_slot = _consumed++ % _slots.size();
+  _current_fresh = upcoming.length;
+  _current = window(prefix, carried + upcoming.length);
+  return _current;
+}
+
+void stream_reader::carry(size_t bytes) {
+  runtime_assert(bytes <= _carry_capacity, "Carry must fit into carry capacity.");
+  runtime_assert(bytes <= _current.size(), "Carry must not exceed the current window.");
+  runtime_assert(bytes == 0 || _current_fresh > 0, "Input ended, carried bytes can not be completed.");
+  _pending_carry = bytes;
+}
+
+#endif
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Reads a file descriptor on a background thread into a ring of aligned
+// buffers, handing out fixed-size windows while the following reads are in
+// flight. Memory stays bounded by `buffers * (window_size + carry_capacity)`.
+//
+// Records that straddle a window boundary are handled with `carry`: the last
+// `n` bytes of the current window are copied in front of the next one, so the
+// next window starts with the complete record.
+//
+// Pipes are read sequentially, regular files with `pread`. Destruction waits
+// for a read that is already in flight.
+//
+// A descriptor passed in is read from its current position. When the reader
+// is destroyed, the descriptor is left just after the last byte fetched. That
+// includes read-ahead the consumer may not have seen.
+class stream_reader {
+public:
+  using window = contiguous_view<const std::byte>;
+
+  static constexpr size_t buffer_alignment = 4096;
+
+  stream_reader(int fd, size_t window_size, size_t buffers = 2, size_t carry_capacity = 0);
+  stream_reader(const std::string& path, size_t window_size, size_t buffers = 2, size_t carry_capacity = 0);
+
+  stream_reader(const stream_reader&) = delete;
+  stream_reader& operator=(const stream_reader&) = delete;
+
+  ~stream_reader();
+
+  // Returns the next window, or an empty view at end of input. Releases the
+  // previous window, which must not be used afterwards. Rethrows read errors.
+  window next();
+
+  // Keeps the last `bytes` bytes of the current window for the next one.
+  void carry(size_t bytes);
+
+  size_t window_size() const noexcept {
+    return _window_size;
+  }
+
+private:
+  struct aligned_delete {
+    void operator()(std::byte* p) const;
+  };
+
+  enum class slot_state {
+    free,
+    ready,
+  };
+
+  struct slot {
+    std::unique_ptr<std::byte[], aligned_delete> buffer;
+    size_t length = 0;
+    slot_state state = slot_state::free;
+  };
+
+  stream_reader(int fd, bool owns_fd, size_t window_size, size_t buffers, size_t carry_capacity);
+
+  void read_loop();
+  size_t fill(std::byte* dst);
+
+  static constexpr size_t no_slot = static_cast<size_t>(-1);
+
+  int _fd;
+  bool _owns_fd;
+  size_t _window_size;
+  size_t _carry_capacity;
+  std::vector<slot> _slots;
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  bool _stop = false;
+  bool _eof = false;
+  size_t _filled = 0;
+  std::exception_ptr _error;
+
+  // Touched by the reader thread only.
+  unsigned long long _offset = 0;
+  bool _use_pread = true;
+
+  // Touched by the consumer only.
+  size_t _consumed = 0;
+  size_t _current_slot = no_slot;
+  window _current;
+  size_t _current_fresh = 0;
+  size_t _pending_carry = 0;
+
+  std::thread _thread;
+};
@@ -0,0 +1,254 @@
+#include "string-interner.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <mutex>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define STRING_INTERNER_HAS_SSE2 1
+#endif
+
+namespace {
+
+inline constexpr std::int8_t empty_control = -128;
+
+struct group_masks {
+  unsigned match;
+  unsigned empty;
+};
+
+group_masks scan_group(const std::int8_t* control, std::int8_t tag) {
+#ifdef STRING_INTERNER_HAS_SSE2
+  __m128i group = _mm_loadu_si128(reinterpret_cast<const __m128i*>(control));
+  auto match = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(group, _mm_set1_epi8(tag))));
+  // Only empty slots have the high bit set.
+  auto empty = static_cast<unsigned>(_mm_movemask_epi8(group));
+  return {match, empty};
+#else
+  group_masks masks{0, 0};
+  for (unsigned i = 0; i < 16; ++i) {
+    masks.match |= static_cast<unsigned>(control[i] == tag) << i;
+    masks.empty |= static_cast<unsigned>(control[i] == empty_control) << i;
+  }
+  return masks;
+#endif
+}
+
+std::int8_t tag_of(std::uint64_t hash) {
+  return static_cast<std::int8_t>(hash & 0x7F);
+}
+
+bool same_text(char_view a, char_view b) {
+  return a.size() == b.size() && (a.empty() || std::memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+} // namespace
+
+string_interner::string_interner(size_t expected_keys) {
+  _records.reserve(expected_keys);
+  rehash(std::bit_ceil(std::max(group_size, expected_keys + expected_keys / 7 + 1)));
+}
+
+// Multiply-xorshift over 8-byte words with a murmur3 finalizer: cheap for
+// short identifiers and good enough in both the low bits (slot position) and
+// the high bits (shard).
+std::uint64_t string_interner::hash(char_view key) noexcept {
+  constexpr std::uint64_t k = 0x9E3779B97F4A7C15;
+  const char* p = key.data();
+  size_t n = key.size();
+  std::uint64_t h = n * k;
+  for (; n >= 8; n -= 8, p += 8) {
+    std::uint64_t word;
+    std::memcpy(&word, p, 8);
+    h = (h ^ word) * k;
+    h ^= h >> 29;
+  }
+  if (n > 0) {
+    std::uint64_t word = 0;
+    std::memcpy(&word, p, n);
+    h = (h ^ word) * k;
+  }
+  h ^= h >> 33;
+  h *= 0xFF51AFD7ED558CCD;
+  h ^= h >> 33;
+  h *= 0xC4CEB9FE1A85EC53;
+  h ^= h >> 33;
+  return h;
+}
+
+size_t string_interner::probe(char_view key, std::uint64_t hash, bool& found) const {
+  size_t mask = _capacity - 1;
+  size_t pos = (hash >> 7) & mask;
+  std::int8_t tag = tag_of(hash);
+  for (size_t step = group_size;; pos = (pos + step) & mask, step += group_size) {
+    group_masks masks = scan_group(_control.data() + pos, tag);
+    for (unsigned match = masks.match; match != 0; match &= match - 1) {
+      size_t slot = (pos + static_cast<size_t>(std::countr_zero(match))) & mask;
+      if (same_text(text_at(_slots[slot]), key)) {
+        found = true;
+        return slot;
+      }
+    }
+    if (masks.empty != 0) {
+      found = false;
+      return (pos + static_cast<size_t>(std::countr_zero(masks.empty))) & mask;
+    }
+  }
+}
+
+// The first group_size control bytes are mirrored past the end, so a group
+// starting near the end can be loaded without wrapping.
+void string_interner::set_control(size_t slot, std::int8_t value) {
+  _control[slot] = value;
+  if (slot < group_size) {
+    _control[_capacity + slot] = value;
+  }
+}
+
+void string_interner::rehash(size_t capacity) {
+  _capacity = capacity;
+  _control.assign(capacity + group_size, empty_control);
+  _slots.assign(capacity, 0);
+  for (std::uint32_t id = 0; id < _records.size(); ++id) {
+    bool found;
+    char_view text = text_at(id);
+    std::uint64_t h = hash(text);
+    size_t slot = probe(text, h, found);
+    set_control(slot, tag_of(h));
+    _slots[slot] = id;
+  }
+}
+
+// Appends the key's length as a varint followed by its bytes and returns the
+// record's position.
+std::uint32_t string_interner::store(char_view key) {
+  size_t n = key.size();
+  char prefix[10];
+  size_t prefix_length = 0;
+  for (size_t rest = n;; rest >>= 7) {
+    prefix[prefix_length++] = static_cast<char>((rest & 0x7F) | (rest >= 0x80 ? 0x80 : 0));
+    if (rest < 0x80) {
+      break;
+    }
+  }
+  size_t record = prefix_length + n;
+
+  size_t chunk;
+  size_t offset;
+  if (n > chunk_size / 4 || record > chunk_size - _used) {
+    runtime_assert(_chunks.size() < max_chunks, "Interner arena is full.");
+  }
+  if (n > chunk_size / 4) {
+    // Large keys get a chunk of their own instead of wasting the current one.
+    _chunks.push_back(std::make_unique_for_overwrite<char[]>(record));
+    _arena_bytes += record;
+    chunk = _chunks.size() - 1;
+    offset = 0;
+  } else {
+    if (record > chunk_size - _used) {
+      _chunks.push_back(std::make_unique_for_overwrite<char[]>(chunk_size));
+      _arena_bytes += chunk_size;
+      _current_chunk = _chunks.size() - 1;
+      _used = 0;
+    }
+    chunk = _current_chunk;
+    offset = _used;
+    _used += record;
+  }
+  char* target = _chunks[chunk].get() + offset;
+  std::memcpy(target, prefix, prefix_length);
+  if (n > 0) {
+    std::memcpy(target + prefix_length, key.data(), n);
+  }
+  return static_cast<std::uint32_t>(chunk << offset_bits | offset);
+}
+
+interned_string string_interner::intern_hashed(char_view key, std::uint64_t hash) {
+  if ((_records.size() + 1) * 8 > _capacity * 7) {
+    rehash(std::max(group_size, _capacity * 2));
+  }
+  bool found;
+  size_t slot = probe(key, hash, found);
+  if (found) {
+    std::uint32_t id = _slots[slot];
+    return {id, text_at(id)};
+  }
+
+  runtime_assert(_records.size() < UINT32_MAX, "Too many interned strings.");
+  auto id = static_cast<std::uint32_t>(_records.size());
+  _records.push_back(store(key));
+  set_control(slot, tag_of(hash));
+  _slots[slot] = id;
+  return {id, text_at(id)};
+}
+
+std::optional<interned_string> string_interner::find_hashed(char_view key, std::uint64_t hash) const {
+  if (_capacity == 0) {
+    return std::nullopt;
+  }
+  bool found;
+  size_t slot = probe(key, hash, found);
+  if (!found) {
+    return std::nullopt;
+  }
+  std::uint32_t id = _slots[slot];
+  return interned_string{id, text_at(id)};
+}
+
+size_t string_interner::memory_usage() const noexcept {
+  return _arena_bytes + _control.capacity() * sizeof(std::int8_t) + _slots.capacity() * sizeof(std::uint32_t) +
+         _records.capacity() * sizeof(std::uint32_t) + _chunks.capacity() * sizeof(std::unique_ptr<char[]>);
+}
+
+concurrent_string_interner::concurrent_string_interner(size_t shards)
+    : _shard_bits(static_cast<unsigned>(std::bit_width(std::bit_ceil(std::max<size_t>(shards, 1))) - 1))
+    , _shards(std::make_unique<shard[]>(size_t{1} << _shard_bits)) {
+  runtime_assert(_shard_bits < 16, "Too many shards.");
+}
+
+interned_string concurrent_string_interner::global(interned_string local, size_t shard) const {
+  runtime_assert(local.id < (UINT32_MAX >> _shard_bits), "Too many interned strings.");
+  return {static_cast<std::uint32_t>(local.id << _shard_bits | shard), local.text};
+}
+
+interned_string concurrent_string_interner::intern(char_view key) {
+  std::uint64_t h = string_interner::hash(key);
+  size_t index = shard_of(h);
+  shard& s = _shards[index];
+  {
+    std::shared_lock lock(s.mutex);
+    if (auto hit = s.table.find_hashed(key, h)) {
+      return global(*hit, index);
+    }
+  }
+  std::unique_lock lock(s.mutex);
+  return global(s.table.intern_hashed(key, h), index);
+}
+
+std::optional<interned_string> concurrent_string_interner::find(char_view key) const {
+  std::uint64_t h = string_interner::hash(key);
+  size_t index = shard_of(h);
+  const shard& s = _shards[index];
+  std::shared_lock lock(s.mutex);
+  if (auto hit = s.table.find_hashed(key, h)) {
+    return global(*hit, index);
+  }
+  return std::nullopt;
+}
+
+char_view concurrent_string_interner::text(std::uint32_t id) const {
+  const shard& s = _shards[id & (shards() - 1)];
+  std::shared_lock lock(s.mutex);
+  return s.table.text(id >> _shard_bits);
+}
+
+size_t concurrent_string_interner::size() const {
+  size_t total = 0;
+  for (size_t i = 0; i < shards(); ++i) {
+    std::shared_lock lock(_shards[i].mutex);
+    total += _shards[i].table.size();
+  }
+  return total;
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include "atomic-view.h"
+#include "contiguous-view.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string_view>
+#include <vector>
+
+struct interned_string {
+  std::uint32_t id;
+  char_view text;
+};
+
+// Deduplicates strings. Key bytes are copied once into an arena of large
+// chunks, so the returned views stay valid for the interner's lifetime. A key
+// costs its length plus a varint length prefix (1 byte below 128), a 4-byte
+// arena position per ID and 5 bytes per table slot (at most 7/8 of the slots
+// are used). IDs are dense, in insertion order. The arena holds at most 2^16
+// chunks, 4 GiB of short keys.
+//
+// The table is open-addressed in the style of Swiss tables: one control byte
+// per slot holds 7 bits of the hash, and a probe compares a whole group of 16
+// control bytes against them at once, so keys are only compared on likely
+// hits. Keys are never removed, so there are no tombstones.
+class string_interner {
+public:
+  string_interner() = default;
+  explicit string_interner(size_t expected_keys);
+
+  interned_string intern(char_view key) {
+    return intern_hashed(key, hash(key));
+  }
+
+  interned_string intern(std::string_view key) {
+    return intern(char_view(key.data(), key.size()));
+  }
+
+  std::optional<interned_string> find(char_view key) const {
+    return find_hashed(key, hash(key));
+  }
+
+  std::optional<interned_string> find(std::string_view key) const {
+    return find(char_view(key.data(), key.size()));
+  }
+
+  char_view text(std::uint32_t id) const {
+    runtime_assert(id < _records.size(), "Unknown string id.");
+    return text_at(id);
+  }
+
+  size_t size() const noexcept {
+    return _records.size();
+  }
+
+  // Bytes held by the key arena, and by the arena plus all tables.
+  size_t arena_bytes() const noexcept {
+    return _arena_bytes;
+  }
+
+  size_t memory_usage() const noexcept;
+
+  static std::uint64_t hash(char_view key) noexcept;
+
+private:
+  friend class concurrent_string_interner;
+
+  inline static constexpr size_t group_size = 16;
+  // A record's position is its chunk index above `offset_bits` and its offset
+  // within the chunk below.
+  inline static constexpr unsigned offset_bits = 16;
+  inline static constexpr size_t chunk_size = size_t{1} << offset_bits;
+  inline static constexpr size_t max_chunks = size_t{1} << (32 - offset_bits);
+
+  char_view text_at(std::uint32_t id) const {
+    std::uint32_t record = _records[id];
+    const char* p = _chunks[record >> offset_bits].get() + (record & (chunk_size - 1));
+    size_t length = 0;
+    for (unsigned shift = 0;; shift += 7) {
+      auto b = static_cast<unsigned char>(*p++);
+      length |= size_t{b & 0x7Fu} << shift;
+      if (b < 0x80) {
+        break;
+      }
+    }
+    return char_view(p, length);
+  }
+
+  interned_string intern_hashed(char_view key, std::uint64_t hash);
+  std::optional<interned_string> find_hashed(char_view key, std::uint64_t hash) const;
+
+  // Slot holding `key`, or the first empty slot of its probe sequence.
+  size_t probe(char_view key, std::uint64_t hash, bool& found) const;
+  void set_control(size_t slot, std::int8_t value);
+  void rehash(size_t capacity);
+  std::uint32_t store(char_view key);
+
+  std::vector<std::int8_t> _control;
+  std::vector<std::uint32_t> _slots;
+  std::vector<std::uint32_t> _records;
+  size_t _capacity = 0;
+
+  std::vector<std::unique_ptr<char[]>> _chunks;
+  size_t _current_chunk = 0;
+  size_t _used = chunk_size;
+  size_t _arena_bytes = 0;
+};
+
+// Thread-safe interner split into independently locked shards chosen by the
+// top bits of the hash; lookups of keys that are already present only take
+// a shared lock. IDs are dense within each shard and interleaved across them
+// (`local_id * shards + shard`), so they stay small but are not consecutive.
+class concurrent_string_interner {
+public:
+  explicit concurrent_string_interner(size_t shards = 16);
+
+  interned_string intern(char_view key);
+
+  interned_string intern(std::string_view key) {
+    return intern(char_view(key.data(), key.size()));
+  }
+
+  std::optional<interned_string> find(char_view key) const;
+
+  std::optional<interned_string> find(std::string_view key) const {
+    return find(char_view(key.data(), key.size()));
+  }
+
+  char_view text(std::uint32_t id) const;
+
+  size_t size() const;
+
+  size_t shards() const noexcept {
+    return size_t{1} << _shard_bits;
+  }
+
+private:
+  struct alignas(cache_line_size) shard {
+    mutable std::shared_mutex mutex;
+    string_interner table;
+  };
+
+  size_t shard_of(std::uint64_t hash) const noexcept {
+    return _shard_bits == 0 ? 0 : static_cast<size_t>(hash >> (64 - _shard_bits));
+  }
+
+  interned_string global(interned_string local, size_t shard) const;
+
+  unsigned _shard_bits = 0;
+  std::unique_ptr<shard[]> _shards;
+};
@@ -0,0 +1,248 @@
+#include "text-search.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <queue>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define TEXT_SEARCH_HAS_SSE2 1
+#endif
+
+namespace {
+
+using byte = unsigned char;
+
+size_t find_short(const byte* h, size_t n, const byte* needle, size_t m) {
+  size_t last = m - 1;
+  size_t i = 0;
+#ifdef TEXT_SEARCH_HAS_SSE2
+  __m128i first_byte = _mm_set1_epi8(static_cast<char>(needle[0]));
+  __m128i last_byte = _mm_set1_epi8(static_cast<char>(needle[last]));
+  for (; i + last + 16 <= n; i += 16) {
+    __m128i block_first = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i));
+    __m128i block_last = _mm_loadu_si128(reinterpret_cast<const __m128i*>(h + i + last));
+    __m128i eq = _mm_and_si128(_mm_cmpeq_epi8(block_first, first_byte), _mm_cmpeq_epi8(block_last, last_byte));
+    auto mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+    while (mask != 0) {
+      size_t pos = i + static_cast<size_t>(std::countr_zero(mask));
+      if (m <= 2 || std::memcmp(h + pos + 1, needle + 1, m - 2) == 0) {
+        return pos;
+      }
+      mask &= mask - 1;
+    }
+  }
+#endif
+  for (; i + m <= n; ++i) {
+    if (h[i] == needle[0] && h[i + last] == needle[last] && std::memcmp(h + i, needle, m) == 0) {
+      return i;
+    }
+  }
+  return dynamic_extent;
+}
+
+// Crochemore-Perrin two-way search with a bad-character shift on the last
+// byte of the window.
+size_t find_two_way(const byte* h, size_t n, const byte* needle, size_t m) {
+  std::bitset<256> byteset;
+  size_t shift[256] = {};
+  for (size_t i = 0; i < m; ++i) {
+    byteset[needle[i]] = true;
+    shift[needle[i]] = i + 1;
+  }
+
+  auto max_suffix = [needle, m](bool reversed, size_t& period) {
+    ptrdiff_t ip = -1;
+    size_t jp = 0;
+    size_t k = 1;
+    period = 1;
+    while (jp + k < m) {
+      byte a = needle[static_cast<size_t>(ip + static_cast<ptrdiff_t>(k))];
+      byte b = needle[jp + k];
+      if (a == b) {
+        if (k == period) {
+          jp += period;
+          k = 1;
+        } else {
+          ++k;
+        }
+      } else if (reversed ? a < b : a > b) {
+        jp += k;
+        k = 1;
+        period = static_cast<size_t>(static_cast<ptrdiff_t>(jp) - ip);
+      } else {
+        ip = static_cast<ptrdiff_t>(jp++);
+        k = period = 1;
+      }
+    }
+    return ip;
+  };
+
+  size_t p0;
+  size_t p1;
+  ptrdiff_t ms0 = max_suffix(false, p0);
+  ptrdiff_t ms1 = max_suffix(true, p1);
+  ptrdiff_t ms = ms1 > ms0 ? ms1 : ms0;
+  size_t p = ms1 > ms0 ? p1 : p0;
+  size_t critical = static_cast<size_t>(ms + 1);
+
+  size_t mem0;
+  if (std::memcmp(needle, needle + p, critical) != 0) {
+    mem0 = 0;
+    p = std::max(critical, m - critical) + 1;
+  } else {
+    mem0 = m - p;
+  }
+
+  size_t mem = 0;
+  for (size_t pos = 0; pos + m <= n;) {
+    const byte* w = h + pos;
+    byte tail = w[m - 1];
+    if (!byteset[tail]) {
+      pos += m;
+      mem = 0;
+      continue;
+    }
+    size_t k = m - shift[tail];
+    if (k != 0) {
+      pos += k;
+      mem = 0;
+      continue;
+    }
+
+    for (k = std::max(critical, mem); k < m && needle[k] == w[k]; ++k) {}
+    if (k < m) {
+      pos += k - critical + 1;
+      mem = 0;
+      continue;
+    }
+    for (k = critical; k > mem && needle[k - 1] == w[k - 1]; --k) {}
+    if (k <= mem) {
+      return pos;
+    }
+    pos += p;
+    mem = mem0;
+  }
+  return dynamic_extent;
+}
+
+} // namespace
+
+size_t find_substring(char_view haystack, char_view needle) {
+  const auto* h = reinterpret_cast<const byte*>(haystack.data());
+  const auto* nd = reinterpret_cast<const byte*>(needle.data());
+  size_t n = haystack.size();
+  size_t m = needle.size();
+  if (m == 0) {
+    return 0;
+  }
+  if (m > n) {
+    return dynamic_extent;
+  }
+  if (m == 1) {
+    const void* hit = std::memchr(h, nd[0], n);
+    return hit == nullptr ? dynamic_extent : static_cast<size_t>(static_cast<const byte*>(hit) - h);
+  }
+  return m > two_way_threshold ? find_two_way(h, n, nd, m) : find_short(h, n, nd, m);
+}
+
+bool contains_substring(char_view haystack, char_view needle) {
+  return find_substring(haystack, needle) != dynamic_extent;
+}
+
+size_t count_substring(char_view haystack, char_view needle) {
+  runtime_assert(!needle.empty(), "Needle must not be empty.");
+  size_t count = 0;
+  for (size_t pos = find_substring(haystack, needle); pos != dynamic_extent;) {
+    ++count;
+    haystack = haystack.subview(pos + needle.size());
+    pos = find_substring(haystack, needle);
+  }
+  return count;
+}
+
+multi_pattern_matcher::multi_pattern_matcher(const std::vector<std::string>& patterns) {
+  constexpr std::uint32_t none = static_cast<std::uint32_t>(-1);
+
+  _next.assign(alphabet, none);
+  std::vector<std::vector<std::uint32_t>> outputs(1);
+  for (size_t id = 0; id < patterns.size(); ++id) {
+    const std::string& pattern = patterns[id];
+    runtime_assert(!pattern.empty(), "Patterns must not be empty.");
+    _first_bytes[static_cast<byte>(pattern[0])] = true;
+    std::uint32_t state = 0;
+    for (char c : pattern) {
+      std::uint32_t& target = _next[state * alphabet + static_cast<byte>(c)];
+      if (target == none) {
+        target = static_cast<std::uint32_t>(outputs.size());
+        outputs.emplace_back();
+        _next.resize(_next.size() + alphabet, none);
+      }
+      state = _next[state * alphabet + static_cast<byte>(c)];
+    }
+    outputs[state].push_back(static_cast<std::uint32_t>(id));
+    _lengths.push_back(pattern.size());
+  }
+
+  size_t states = outputs.size();
+  std::vector<std::uint32_t> fail(states, 0);
+  _output_link.assign(states, 0);
+  _has_output.assign(states, false);
+  for (size_t s = 0; s < states; ++s) {
+    _has_output[s] = !outputs[s].empty();
+  }
+
+  // Breadth-first, so the failure state of every node is finished before the
+  // node itself; missing transitions are filled in from the failure state,
+  // which turns the trie into a DFA.
+  std::queue<std::uint32_t> queue;
+  for (size_t c = 0; c < alphabet; ++c) {
+    std::uint32_t& target = _next[c];
+    if (target == none) {
+      target = 0;
+    } else {
+      queue.push(target);
+    }
+  }
+  while (!queue.empty()) {
+    std::uint32_t u = queue.front();
+    queue.pop();
+    for (size_t c = 0; c < alphabet; ++c) {
+      std::uint32_t& target = _next[u * alphabet + c];
+      std::uint32_t via_fail = _next[fail[u] * alphabet + c];
+      if (target == none) {
+        target = via_fail;
+      } else {
+        fail[target] = via_fail;
+        _output_link[target] = _has_output[via_fail] ? via_fail : _output_link[via_fail];
+        queue.push(target);
+      }
+    }
+  }
+
+  _output_begin.reserve(states + 1);
+  for (const auto& list : outputs) {
+    _output_begin.push_back(static_cast<std::uint32_t>(_outputs.size()));
+    _outputs.insert(_outputs.end(), list.begin(), list.end());
+  }
+  _output_begin.push_back(static_cast<std::uint32_t>(_outputs.size()));
+}
+
+std::vector<text_match> multi_pattern_matcher::find_all(char_view haystack) const {
+  std::vector<text_match> result;
+  for_each_match(haystack, [&result](const text_match& match) { result.push_back(match); });
+  return result;
+}
+
+bool multi_pattern_matcher::contains_any(char_view haystack) const {
+  const auto* text = reinterpret_cast<const byte*>(haystack.data());
+  std::uint32_t state = 0;
+  for (size_t i = 0; i < haystack.size(); ++i) {
+    state = _next[state * alphabet + text[i]];
+    if (_has_output[state] || _output_link[state] != 0) {
+      return true;
+    }
+  }
+  return false;
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <array>
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Offset of the first occurrence of `needle` in `haystack`, or
+// `dynamic_extent`. Short needles are located by comparing their first and
+// last byte against 16 positions at once and verifying candidates; needles
+// longer than `two_way_threshold` use the two-way algorithm, which is linear
+// in the worst case.
+size_t find_substring(char_view haystack, char_view needle);
+
+bool contains_substring(char_view haystack, char_view needle);
+
+// Number of non-overlapping occurrences.
+size_t count_substring(char_view haystack, char_view needle);
+
+inline constexpr size_t two_way_threshold = 64;
+
+struct text_match {
+  size_t pattern;
+  char_view text;
+};
+
+// Aho-Corasick automaton with a dense transition table, compiled once per
+// pattern set and reusable across any number of buffers. Matches are
+// reported in order of their end position as subviews of the searched buffer.
+class multi_pattern_matcher {
+public:
+  explicit multi_pattern_matcher(const std::vector<std::string>& patterns);
+
+  size_t patterns() const noexcept {
+    return _lengths.size();
+  }
+
+  template <typename F>
+  void for_each_match(char_view haystack, F&& fn) const {
+    const auto* text = reinterpret_cast<const unsigned char*>(haystack.data());
+    size_t n = haystack.size();
+    std::uint32_t state = 0;
+    for (size_t i = 0; i < n; ++i) {
+      if (state == 0) {
+        // Nothing is partially matched, so skip bytes that start no pattern.
+        while (i < n && !_first_bytes[text[i]]) {
+          ++i;
+        }
+        if (i == n) {
+          break;
+        }
+      }
+      state = _next[state * alphabet + text[i]];
+      for (std::uint32_t s = _has_output[state] ? state : _output_link[state]; s != 0; s = _output_link[s]) {
+        for (std::uint32_t p = _output_begin[s]; p < _output_begin[s + 1]; ++p) {
+          size_t pattern = _outputs[p];
+          size_t length = _lengths[pattern];
+          fn(text_match{pattern, haystack.subview(i + 1 - length, length)});
+        }
+      }
+    }
+  }
+
+  std::vector<text_match> find_all(char_view haystack) const;
+
+  bool contains_any(char_view haystack) const;
+
+private:
+  static constexpr size_t alphabet = 256;
+
+  std::vector<std::uint32_t> _next;
+  std::vector<std::uint32_t> _output_link;
+  std::vector<bool> _has_output;
+  std::vector<std::uint32_t> _output_begin;
+  std::vector<std::uint32_t> _outputs;
+  std::vector<size_t> _lengths;
+  std::bitset<alphabet> _first_bytes;
+};
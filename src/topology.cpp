@@ -0,0 +1,226 @@
+#include "topology.h"
+
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <utility>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+namespace {
+
+constexpr size_t default_l2_bytes = 256 * 1024;
+constexpr size_t default_llc_bytes = 8 * 1024 * 1024;
+constexpr size_t tile_alignment = 64;
+
+bool read_line(const std::string& path, std::string& out) {
+  std::ifstream in(path);
+  return static_cast<bool>(std::getline(in, out));
+}
+
+bool read_unsigned(const std::string& path, unsigned& out) {
+  std::string line;
+  if (!read_line(path, line) || line.empty() || !std::isdigit(static_cast<unsigned char>(line[0]))) {
+    return false;
+  }
+  out = static_cast<unsigned>(std::stoul(line));
+  return true;
+}
+
+} // namespace
+
+size_t parse_cache_size(const std::string& text) {
+  size_t pos = 0;
+  size_t value = 0;
+  while (pos < text.size() && std::isdigit(static_cast<unsigned char>(text[pos]))) {
+    value = value * 10 + static_cast<size_t>(text[pos] - '0');
+    ++pos;
+  }
+  if (pos < text.size()) {
+    switch (std::toupper(static_cast<unsigned char>(text[pos]))) {
+    case 'K':
+      return value * 1024;
+    case 'M':
+      return value * 1024 * 1024;
+    case 'G':
+      return value * 1024 * 1024 * 1024;
+    default:
+      break;
+    }
+  }
+  return value;
+}
+
+std::vector<unsigned> parse_cpu_list(const std::string& text) {
+  std::vector<unsigned> result;
+  std::stringstream in(text);
+  std::string range;
+  while (std::getline(in, range, ',')) {
+    if (range.empty() || !std::isdigit(static_cast<unsigned char>(range[0]))) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    unsigned first = static_cast<unsigned>(std::stoul(range.substr(0, dash)));
+    unsigned last = dash == std::string::npos ? first : static_cast<unsigned>(std::stoul(range.substr(dash + 1)));
+    for (unsigned cpu = first; cpu <= last; ++cpu) {
+      result.push_back(cpu);
+    }
+  }
+  return result;
+}
+
+size_t cpu_topology::packages() const {
+  std::set<unsigned> ids;
+  for (const cpu_info& cpu : cpus) {
+    ids.insert(cpu.package_id);
+  }
+  return std::max<size_t>(1, ids.size());
+}
+
+std::vector<unsigned> cpu_topology::physical_cores() const {
+  std::vector<cpu_info> sorted = cpus;
+  std::stable_sort(sorted.begin(), sorted.end(), [](const cpu_info& a, const cpu_info& b) {
+    return a.package_id != b.package_id ? a.package_id < b.package_id : a.core_id < b.core_id;
+  });
+
+  std::vector<unsigned> result;
+  for (size_t i = 0; i < sorted.size(); ++i) {
+    if (i == 0 || sorted[i].package_id != sorted[i - 1].package_id || sorted[i].core_id != sorted[i - 1].core_id) {
+      result.push_back(sorted[i].id);
+    }
+  }
+  return result;
+}
+
+void cpu_topology::restrict_to(const std::vector<unsigned>& allowed) {
+  std::vector<cpu_info> kept;
+  for (const cpu_info& cpu : cpus) {
+    if (std::find(allowed.begin(), allowed.end(), cpu.id) != allowed.end()) {
+      kept.push_back(cpu);
+    }
+  }
+  if (!kept.empty()) {
+    cpus = std::move(kept);
+  }
+}
+
+cpu_topology read_cpu_topology(const std::string& root) {
+  cpu_topology result{{}, default_l2_bytes, default_llc_bytes};
+
+  std::string online;
+  std::vector<unsigned> ids;
+  if (read_line(root + "/online", online)) {
+    ids = parse_cpu_list(online);
+  }
+
+  for (unsigned id : ids) {
+    std::string dir = root + "/cpu" + std::to_string(id);
+    cpu_info cpu{id, id, 0};
+    read_unsigned(dir + "/topology/core_id", cpu.core_id);
+    read_unsigned(dir + "/topology/physical_package_id", cpu.package_id);
+    result.cpus.push_back(cpu);
+  }
+
+  if (!ids.empty()) {
+    unsigned llc_level = 0;
+    for (unsigned index = 0;; ++index) {
+      std::string dir = root + "/cpu" + std::to_string(ids.front()) + "/cache/index" + std::to_string(index);
+      unsigned level;
+      std::string type;
+      std::string size;
+      if (!read_unsigned(dir + "/level", level) || !read_line(dir + "/type", type) || !read_line(dir + "/size", size)) {
+        break;
+      }
+      if (type == "Instruction") {
+        continue;
+      }
+      if (level == 2) {
+        result.l2_bytes = parse_cache_size(size);
+      }
+      if (level >= 2 && level >= llc_level) {
+        llc_level = level;
+        result.llc_bytes = parse_cache_size(size);
+      }
+    }
+  }
+
+  if (result.cpus.empty()) {
+    unsigned n = std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned id = 0; id < n; ++id) {
+      result.cpus.push_back({id, id, 0});
+    }
+  }
+  return result;
+}
+
+cpu_topology current_cpu_topology() {
+  cpu_topology result = read_cpu_topology();
+  result.restrict_to(allowed_cpus());
+  return result;
+}
+
+std::vector<unsigned> allowed_cpus() {
+  std::vector<unsigned> result;
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+    for (unsigned cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+      if (CPU_ISSET(cpu, &set)) {
+        result.push_back(cpu);
+      }
+    }
+  }
+#endif
+  return result;
+}
+
+bool pin_current_thread(unsigned cpu) {
+#ifdef __linux__
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  CPU_SET(cpu, &set);
+  return sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+  static_cast<void>(cpu);
+  return false;
+#endif
+}
+
+std::string tiling_plan::describe() const {
+  std::stringstream out;
+  out << workers << " worker(s) on " << packages << " package(s), " << tiles << " tile(s) of " << tile_elements
+      << " element(s); L2 " << l2_bytes / 1024 << "K, LLC " << llc_bytes / 1024 << "K; cpus {";
+  for (size_t i = 0; i < cpus.size(); ++i) {
+    out << (i == 0 ? "" : ", ") << cpus[i];
+  }
+  out << "}";
+  return out.str();
+}
+
+view_partitioner::view_partitioner(cpu_topology topology)
+    : _topology(std::move(topology)) {}
+
+tiling_plan view_partitioner::plan(size_t elements, size_t element_size) const {
+  tiling_plan result{};
+  result.l2_bytes = _topology.l2_bytes;
+  result.llc_bytes = _topology.llc_bytes;
+  result.packages = _topology.packages();
+  result.cpus = _topology.physical_cores();
+
+  // Half of L2 per tile leaves room for whatever else the worker touches.
+  element_size = std::max<size_t>(1, element_size);
+  size_t tile_bytes = std::max(tile_alignment, _topology.l2_bytes / 2 / tile_alignment * tile_alignment);
+  size_t tile_elements = std::max<size_t>(1, tile_bytes / element_size);
+
+  result.tile_elements = std::min(tile_elements, std::max<size_t>(1, elements));
+  result.tiles = (elements + result.tile_elements - 1) / result.tile_elements;
+  result.workers = std::max<size_t>(1, std::min(result.cpus.size(), result.tiles));
+  result.cpus.resize(result.workers);
+  return result;
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+struct cpu_info {
+  unsigned id;
+  unsigned core_id;
+  unsigned package_id;
+};
+
+struct cpu_topology {
+  std::vector<cpu_info> cpus;
+  size_t l2_bytes;
+  size_t llc_bytes;
+
+  size_t packages() const;
+
+  // One logical CPU per physical core, ordered by package so that consecutive
+  // workers share a last-level cache.
+  std::vector<unsigned> physical_cores() const;
+
+  // Drops CPUs missing from `allowed`. Keeps the list as is if `allowed` is
+  // empty or would leave no CPU.
+  void restrict_to(const std::vector<unsigned>& allowed);
+};
+
+// Reads `online`, `cpuN/topology` and `cpuN/cache` under `root`. Anything
+// missing (non-Linux, containers hiding sysfs) falls back to
+// `std::thread::hardware_concurrency()` CPUs on a single package.
+cpu_topology read_cpu_topology(const std::string& root = "/sys/devices/system/cpu");
+
+// `read_cpu_topology()` restricted to `allowed_cpus()`, so that workers are
+// not pinned to CPUs a cpuset or `taskset` has taken away.
+cpu_topology current_cpu_topology();
+
+// CPUs in the affinity mask of the calling thread, or an empty list if the
+// platform does not report it.
+std::vector<unsigned> allowed_cpus();
+
+// Parses sysfs cache sizes such as "48K", "2048K" or "8M".
+size_t parse_cache_size(const std::string& text);
+
+// Parses sysfs CPU lists such as "0-3,8,10-11".
+std::vector<unsigned> parse_cpu_list(const std::string& text);
+
+// Returns false if the platform does not support affinity or the call failed.
+bool pin_current_thread(unsigned cpu);
+
+struct tiling_plan {
+  size_t workers;
+  // Half of L2.
+  size_t tile_elements;
+  size_t tiles;
+  size_t l2_bytes;
+  size_t llc_bytes;
+  size_t packages;
+  std::vector<unsigned> cpus;
+
+  // Tiles [tile_begin(w), tile_begin(w + 1)) belong to worker `w`.
+  size_t tile_begin(size_t worker) const {
+    return tiles * worker / workers;
+  }
+
+  std::string describe() const;
+};
+
+class view_partitioner {
+  cpu_topology _topology;
+
+public:
+  explicit view_partitioner(cpu_topology topology = current_cpu_topology());
+
+  const cpu_topology& topology() const noexcept {
+    return _topology;
+  }
+
+  tiling_plan plan(size_t elements, size_t element_size) const;
+
+  // Calls `fn(worker, tile)` for every tile, each worker on its own thread
+  // pinned to one physical core. A worker's tiles are adjacent in memory. The
+  // calling thread only waits, so its own affinity is left untouched. A worker
+  // that throws skips its remaining tiles; once all workers are joined, the
+  // exception of the lowest-numbered failed worker is rethrown.
+  template <typename T, size_t Extent, typename F>
+  tiling_plan run(contiguous_view<T, Extent> view, F fn, bool pin = true) const {
+    tiling_plan p = plan(view.size(), sizeof(T));
+    std::vector<std::exception_ptr> errors(p.workers);
+    auto work = [&p, &fn, &errors, view, pin](size_t worker) {
+      try {
+        if (pin) {
+          pin_current_thread(p.cpus[worker]);
+        }
+        for (size_t tile = p.tile_begin(worker); tile < p.tile_begin(worker + 1); ++tile) {
+          size_t offset = tile * p.tile_elements;
+          fn(worker, view.subview(offset, std::min(p.tile_elements, view.size() - offset)));
+        }
+      } catch (...) {
+        errors[worker] = std::current_exception();
+      }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(p.workers);
+    try {
+      for (size_t w = 0; w < p.workers; ++w) {
+        threads.emplace_back(work, w);
+      }
+    } catch (...) {
+      for (auto& t : threads) {
+        t.join();
+      }
+      throw;
+    }
+    for (auto& t : threads) {
+      t.join();
+    }
+    for (auto& error : errors) {
+      if (error) {
+        std::rethrow_exception(error);
+      }
+    }
+    return p;
+  }
+
+  // Value-initializes every tile from the worker that will later process it,
+  // so that the kernel places the pages on that worker's NUMA node.
+  template <typename T, size_t Extent>
+  tiling_plan first_touch(contiguous_view<T, Extent> view) const {
+    static_assert(!std::is_const_v<T> && std::is_trivially_default_constructible_v<T>);
+    return run(view, [](size_t, contiguous_view<T> tile) { std::fill(tile.begin(), tile.end(), T{}); });
+  }
+};
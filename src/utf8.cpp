@@ -0,0 +1,491 @@
+#include "utf8.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UTF8_HAS_SSE2 1
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#include <tmmintrin.h>
+#define UTF8_HAS_SSSE3_DISPATCH 1
+#endif
+
+namespace {
+
+using byte = unsigned char;
+
+bool is_continuation(byte b) {
+  return (b & 0xC0) == 0x80;
+}
+
+// Decodes the sequence at `p` into `cp` and returns its length, or 0 if it is
+// not well-formed.
+size_t decode(const byte* p, size_t n, char32_t& cp) {
+  byte b0 = p[0];
+  if (b0 < 0x80) {
+    cp = b0;
+    return 1;
+  }
+  if (b0 < 0xC2) {
+    return 0;
+  }
+  if (b0 < 0xE0) {
+    if (n < 2 || !is_continuation(p[1])) {
+      return 0;
+    }
+    cp = static_cast<char32_t>((b0 & 0x1F) << 6 | (p[1] & 0x3F));
+    return 2;
+  }
+  if (b0 < 0xF0) {
+    if (n < 3 || !is_continuation(p[1]) || !is_continuation(p[2])) {
+      return 0;
+    }
+    if ((b0 == 0xE0 && p[1] < 0xA0) || (b0 == 0xED && p[1] >= 0xA0)) {
+      return 0;
+    }
+    cp = static_cast<char32_t>((b0 & 0x0F) << 12 | (p[1] & 0x3F) << 6 | (p[2] & 0x3F));
+    return 3;
+  }
+  if (b0 < 0xF5) {
+    if (n < 4 || !is_continuation(p[1]) || !is_continuation(p[2]) || !is_continuation(p[3])) {
+      return 0;
+    }
+    if ((b0 == 0xF0 && p[1] < 0x90) || (b0 == 0xF4 && p[1] >= 0x90)) {
+      return 0;
+    }
+    cp = static_cast<char32_t>((b0 & 0x07) << 18 | (p[1] & 0x3F) << 12 | (p[2] & 0x3F) << 6 | (p[3] & 0x3F));
+    return 4;
+  }
+  return 0;
+}
+
+// Writes the UTF-8 form of a valid code point and returns its length.
+size_t encode(char32_t cp, char* out) {
+  if (cp < 0x80) {
+    out[0] = static_cast<char>(cp);
+    return 1;
+  }
+  if (cp < 0x800) {
+    out[0] = static_cast<char>(0xC0 | cp >> 6);
+    out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 2;
+  }
+  if (cp < 0x10000) {
+    out[0] = static_cast<char>(0xE0 | cp >> 12);
+    out[1] = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+    out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 3;
+  }
+  out[0] = static_cast<char>(0xF0 | cp >> 18);
+  out[1] = static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+  out[2] = static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+  out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+  return 4;
+}
+
+size_t encoded_length(char32_t cp) {
+  return 1 + (cp >= 0x80) + (cp >= 0x800) + (cp >= 0x10000);
+}
+
+bool validate_scalar(const byte* p, size_t n) {
+  size_t i = 0;
+  while (i < n) {
+    if (i + 8 <= n) {
+      std::uint64_t word;
+      std::memcpy(&word, p + i, 8);
+      if ((word & 0x8080808080808080) == 0) {
+        i += 8;
+        continue;
+      }
+    }
+    char32_t cp;
+    size_t length = decode(p + i, n - i, cp);
+    if (length == 0) {
+      return false;
+    }
+    i += length;
+  }
+  return true;
+}
+
+#ifdef UTF8_HAS_SSSE3_DISPATCH
+
+// Every error is a property of a byte and the one before it, so three
+// 16-entry lookups (high and low nibble of the previous byte, high nibble of
+// the current one) are ANDed; a set bit names the error class. The only
+// exception, a continuation that the lead byte two or three positions back
+// does expect, is cancelled separately.
+constexpr byte too_short = 1 << 0;
+constexpr byte too_long = 1 << 1;
+constexpr byte overlong_3 = 1 << 2;
+constexpr byte too_large = 1 << 3;
+constexpr byte surrogate = 1 << 4;
+constexpr byte overlong_2 = 1 << 5;
+constexpr byte too_large_1000 = 1 << 6;
+constexpr byte overlong_4 = 1 << 6;
+constexpr byte two_conts = 1 << 7;
+constexpr byte carry = too_short | too_long | two_conts;
+
+alignas(16) constexpr byte byte_1_high[16] = {
+    too_long,  too_long,  too_long,  too_long,  too_long,  too_long,  too_long,  too_long,
+    two_conts, two_conts, two_conts, two_conts,
+    too_short | overlong_2,
+    too_short,
+    too_short | overlong_3 | surrogate,
+    too_short | too_large | too_large_1000 | overlong_4,
+};
+
+alignas(16) constexpr byte byte_1_low[16] = {
+    carry | overlong_3 | overlong_2 | overlong_4,
+    carry | overlong_2,
+    carry,
+    carry,
+    carry | too_large,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000 | surrogate,
+    carry | too_large | too_large_1000,
+    carry | too_large | too_large_1000,
+};
+
+alignas(16) constexpr byte byte_2_high[16] = {
+    too_short, too_short, too_short, too_short, too_short, too_short, too_short, too_short,
+    too_long | overlong_2 | two_conts | overlong_3 | too_large_1000 | overlong_4,
+    too_long | overlong_2 | two_conts | overlong_3 | too_large,
+    too_long | overlong_2 | two_conts | surrogate | too_large,
+    too_long | overlong_2 | two_conts | surrogate | too_large,
+    too_short, too_short, too_short, too_short,
+};
+
+// A block ending in a lead byte that needs more bytes than remain in it.
+alignas(16) constexpr byte incomplete_limit[16] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xEF, 0xDF, 0xBF,
+};
+
+struct utf8_checker {
+  __m128i prev = _mm_setzero_si128();
+  __m128i prev_incomplete = _mm_setzero_si128();
+  __m128i error = _mm_setzero_si128();
+
+  __attribute__((target("ssse3"))) static __m128i lookup(const byte* table, __m128i nibbles) {
+    return _mm_shuffle_epi8(_mm_load_si128(reinterpret_cast<const __m128i*>(table)), nibbles);
+  }
+
+  __attribute__((target("ssse3"))) void check(__m128i input) {
+    if (_mm_movemask_epi8(input) == 0) {
+      error = _mm_or_si128(error, prev_incomplete);
+      prev_incomplete = _mm_setzero_si128();
+      prev = input;
+      return;
+    }
+
+    const __m128i low_nibble = _mm_set1_epi8(0x0F);
+    __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+    __m128i special = _mm_and_si128(
+        _mm_and_si128(
+            lookup(byte_1_high, _mm_and_si128(_mm_srli_epi16(prev1, 4), low_nibble)),
+            lookup(byte_1_low, _mm_and_si128(prev1, low_nibble))
+        ),
+        lookup(byte_2_high, _mm_and_si128(_mm_srli_epi16(input, 4), low_nibble))
+    );
+
+    __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+    __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+    __m128i third = _mm_subs_epu8(prev2, _mm_set1_epi8(0xE0 - 0x80));
+    __m128i fourth = _mm_subs_epu8(prev3, _mm_set1_epi8(0xF0 - 0x80));
+    __m128i expected = _mm_and_si128(_mm_or_si128(third, fourth), _mm_set1_epi8(static_cast<char>(0x80)));
+
+    error = _mm_or_si128(error, _mm_xor_si128(expected, special));
+    prev_incomplete = _mm_subs_epu8(input, _mm_load_si128(reinterpret_cast<const __m128i*>(incomplete_limit)));
+    prev = input;
+  }
+
+  bool ok() const {
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(error, _mm_setzero_si128())) == 0xFFFF;
+  }
+};
+
+__attribute__((target("ssse3"))) bool validate_ssse3(const byte* p, size_t n) {
+  utf8_checker checker;
+  size_t i = 0;
+  for (; i + 64 <= n; i += 64) {
+    __m128i b0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    __m128i b1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 16));
+    __m128i b2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 32));
+    __m128i b3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 48));
+    if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(b0, b1), _mm_or_si128(b2, b3))) == 0) {
+      checker.check(b3);
+      continue;
+    }
+    checker.check(b0);
+    checker.check(b1);
+    checker.check(b2);
+    checker.check(b3);
+  }
+  for (; i + 16 <= n; i += 16) {
+    checker.check(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i)));
+  }
+  // Always one more, zero-padded block: the padding is ASCII, so a sequence
+  // cut off by the end of the input shows up as too short.
+  alignas(16) byte tail[16] = {};
+  std::memcpy(tail, p + i, n - i);
+  checker.check(_mm_load_si128(reinterpret_cast<const __m128i*>(tail)));
+  return checker.ok();
+}
+
+bool has_ssse3() {
+  static const bool supported = __builtin_cpu_supports("ssse3");
+  return supported;
+}
+
+#endif
+
+const byte* bytes_of(char_view text) {
+  return reinterpret_cast<const byte*>(text.data());
+}
+
+// Input units the transcoders decode on the scalar path before retrying the
+// SIMD one. Output capacity is checked once per run when it clearly suffices.
+constexpr size_t scalar_run = 16;
+
+} // namespace
+
+bool validate_utf8(char_view text) {
+#ifdef UTF8_HAS_SSSE3_DISPATCH
+  if (has_ssse3()) {
+    return validate_ssse3(bytes_of(text), text.size());
+  }
+#endif
+  return validate_scalar(bytes_of(text), text.size());
+}
+
+size_t utf32_length_from_utf8(char_view text) {
+  const byte* p = bytes_of(text);
+  size_t n = text.size();
+  size_t count = 0;
+  size_t i = 0;
+#ifdef UTF8_HAS_SSE2
+  // Every byte except a continuation (signed value below -64) starts a code
+  // point.
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    auto starts = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpgt_epi8(v, _mm_set1_epi8(-65))));
+    count += static_cast<size_t>(std::popcount(starts));
+  }
+#endif
+  for (; i < n; ++i) {
+    count += !is_continuation(p[i]);
+  }
+  return count;
+}
+
+size_t utf16_length_from_utf8(char_view text) {
+  const byte* p = bytes_of(text);
+  size_t n = text.size();
+  size_t count = utf32_length_from_utf8(text);
+  size_t i = 0;
+#ifdef UTF8_HAS_SSE2
+  // Four-byte sequences need a surrogate pair.
+  for (; i + 16 <= n; i += 16) {
+    __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+    __m128i four = _mm_cmpeq_epi8(_mm_max_epu8(v, _mm_set1_epi8(static_cast<char>(0xF0))), v);
+    count += static_cast<size_t>(std::popcount(static_cast<unsigned>(_mm_movemask_epi8(four))));
+  }
+#endif
+  for (; i < n; ++i) {
+    count += p[i] >= 0xF0;
+  }
+  return count;
+}
+
+size_t utf8_length_from_utf16(contiguous_view<const char16_t> text) {
+  size_t count = 0;
+  for (char16_t c : text) {
+    // Each half of a surrogate pair accounts for two of the four bytes.
+    count += 1 + (c >= 0x80) + (c >= 0x800) - ((c & 0xF800) == 0xD800);
+  }
+  return count;
+}
+
+size_t utf8_length_from_utf32(contiguous_view<const char32_t> text) {
+  size_t count = 0;
+  for (char32_t c : text) {
+    count += encoded_length(c);
+  }
+  return count;
+}
+
+size_t utf8_to_utf16(char_view in, contiguous_view<char16_t> out) {
+  const byte* p = bytes_of(in);
+  size_t n = in.size();
+  char16_t* o = out.data();
+  size_t capacity = out.size();
+  size_t i = 0;
+  size_t written = 0;
+  while (i < n) {
+#ifdef UTF8_HAS_SSE2
+    if (i + 16 <= n && written + 16 <= capacity) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(v));
+      if (mask == 0) {
+        __m128i zero = _mm_setzero_si128();
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written), _mm_unpacklo_epi8(v, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written + 8), _mm_unpackhi_epi8(v, zero));
+        i += 16;
+        written += 16;
+        continue;
+      }
+      for (size_t ascii = static_cast<size_t>(std::countr_zero(mask)); ascii > 0; --ascii) {
+        o[written++] = p[i++];
+      }
+    }
+#endif
+    // No sequence yields more units than bytes; the last one may run 3 bytes
+    // past the end of the run.
+    size_t run_end = std::min(n, i + scalar_run);
+    bool checked = capacity - written < std::min(n, run_end + 3) - i;
+    while (i < run_end) {
+      char32_t cp = 0;
+      size_t length = decode(p + i, n - i, cp);
+      runtime_assert(length != 0, "Invalid UTF-8 sequence.");
+      i += length;
+      if (cp >= 0x10000) {
+        runtime_assert(!checked || written + 2 <= capacity, "Output view is too small.");
+        cp -= 0x10000;
+        o[written++] = static_cast<char16_t>(0xD800 + (cp >> 10));
+        o[written++] = static_cast<char16_t>(0xDC00 + (cp & 0x3FF));
+      } else {
+        runtime_assert(!checked || written + 1 <= capacity, "Output view is too small.");
+        o[written++] = static_cast<char16_t>(cp);
+      }
+    }
+  }
+  return written;
+}
+
+size_t utf8_to_utf32(char_view in, contiguous_view<char32_t> out) {
+  const byte* p = bytes_of(in);
+  size_t n = in.size();
+  char32_t* o = out.data();
+  size_t capacity = out.size();
+  size_t i = 0;
+  size_t written = 0;
+  while (i < n) {
+#ifdef UTF8_HAS_SSE2
+    if (i + 16 <= n && written + 16 <= capacity) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      auto mask = static_cast<unsigned>(_mm_movemask_epi8(v));
+      if (mask == 0) {
+        __m128i zero = _mm_setzero_si128();
+        __m128i lo = _mm_unpacklo_epi8(v, zero);
+        __m128i hi = _mm_unpackhi_epi8(v, zero);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written), _mm_unpacklo_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written + 4), _mm_unpackhi_epi16(lo, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written + 8), _mm_unpacklo_epi16(hi, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written + 12), _mm_unpackhi_epi16(hi, zero));
+        i += 16;
+        written += 16;
+        continue;
+      }
+      for (size_t ascii = static_cast<size_t>(std::countr_zero(mask)); ascii > 0; --ascii) {
+        o[written++] = p[i++];
+      }
+    }
+#endif
+    size_t run_end = std::min(n, i + scalar_run);
+    bool checked = capacity - written < std::min(n, run_end + 3) - i;
+    while (i < run_end) {
+      char32_t cp = 0;
+      size_t length = decode(p + i, n - i, cp);
+      runtime_assert(length != 0, "Invalid UTF-8 sequence.");
+      runtime_assert(!checked || written + 1 <= capacity, "Output view is too small.");
+      i += length;
+      o[written++] = cp;
+    }
+  }
+  return written;
+}
+
+size_t utf16_to_utf8(contiguous_view<const char16_t> in, contiguous_view<char> out) {
+  const char16_t* p = in.data();
+  size_t n = in.size();
+  char* o = out.data();
+  size_t capacity = out.size();
+  size_t i = 0;
+  size_t written = 0;
+  while (i < n) {
+#ifdef UTF8_HAS_SSE2
+    if (i + 8 <= n && written + 8 <= capacity) {
+      __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i high = _mm_and_si128(v, _mm_set1_epi16(static_cast<short>(0xFF80)));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi16(high, _mm_setzero_si128())) == 0xFFFF) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(o + written), _mm_packus_epi16(v, v));
+        i += 8;
+        written += 8;
+        continue;
+      }
+    }
+#endif
+    // At most 3 bytes per unit; a pair may end one unit past the run.
+    size_t run_end = std::min(n, i + scalar_run);
+    bool checked = capacity - written < 3 * (std::min(n, run_end + 1) - i);
+    while (i < run_end) {
+      char32_t cp = p[i++];
+      if ((cp & 0xF800) == 0xD800) {
+        runtime_assert(cp < 0xDC00 && i < n && (p[i] & 0xFC00) == 0xDC00, "Unpaired UTF-16 surrogate.");
+        cp = 0x10000 + ((cp - 0xD800) << 10) + (p[i++] - 0xDC00);
+      }
+      runtime_assert(!checked || written + encoded_length(cp) <= capacity, "Output view is too small.");
+      written += encode(cp, o + written);
+    }
+  }
+  return written;
+}
+
+size_t utf32_to_utf8(contiguous_view<const char32_t> in, contiguous_view<char> out) {
+  const char32_t* p = in.data();
+  size_t n = in.size();
+  char* o = out.data();
+  size_t capacity = out.size();
+  size_t i = 0;
+  size_t written = 0;
+  while (i < n) {
+#ifdef UTF8_HAS_SSE2
+    if (i + 16 <= n && written + 16 <= capacity) {
+      __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i));
+      __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 4));
+      __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 8));
+      __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p + i + 12));
+      __m128i any = _mm_or_si128(_mm_or_si128(v0, v1), _mm_or_si128(v2, v3));
+      __m128i high = _mm_and_si128(any, _mm_set1_epi32(~0x7F));
+      if (_mm_movemask_epi8(_mm_cmpeq_epi32(high, _mm_setzero_si128())) == 0xFFFF) {
+        __m128i packed = _mm_packus_epi16(_mm_packs_epi32(v0, v1), _mm_packs_epi32(v2, v3));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(o + written), packed);
+        i += 16;
+        written += 16;
+        continue;
+      }
+    }
+#endif
+    size_t run_end = std::min(n, i + scalar_run);
+    bool checked = capacity - written < 4 * (run_end - i);
+    while (i < run_end) {
+      char32_t cp = p[i++];
+      runtime_assert(cp <= 0x10FFFF && (cp & 0xFFFFF800) != 0xD800, "Invalid code point.");
+      runtime_assert(!checked || written + encoded_length(cp) <= capacity, "Output view is too small.");
+      written += encode(cp, o + written);
+    }
+  }
+  return written;
+}
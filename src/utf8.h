@@ -0,0 +1,26 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <cstddef>
+
+// Strict UTF-8 validation: rejects overlong forms, surrogates, code points
+// above U+10FFFF and truncated sequences. Runs of ASCII are skipped 64 bytes
+// at a time; other blocks go through the Keiser-Lemire lookup-table check
+// (SSSE3, picked at runtime) or a scalar decoder.
+bool validate_utf8(char_view text);
+
+// Code units needed to transcode valid input; the result is unspecified for
+// invalid input.
+size_t utf16_length_from_utf8(char_view text);
+size_t utf32_length_from_utf8(char_view text);
+size_t utf8_length_from_utf16(contiguous_view<const char16_t> text);
+size_t utf8_length_from_utf32(contiguous_view<const char32_t> text);
+
+// Transcode `in` into the front of `out` and return the number of code units
+// written. Invalid input or an output view that is too small fail an
+// assertion; size the output with the functions above.
+size_t utf8_to_utf16(char_view in, contiguous_view<char16_t> out);
+size_t utf8_to_utf32(char_view in, contiguous_view<char32_t> out);
+size_t utf16_to_utf8(contiguous_view<const char16_t> in, contiguous_view<char> out);
+size_t utf32_to_utf8(contiguous_view<const char32_t> in, contiguous_view<char> out);
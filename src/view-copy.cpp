@@ -0,0 +1,88 @@
+#include "view-copy.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define VIEW_COPY_HAS_STREAM_STORES 1
+#endif
+
+namespace {
+
+// Below a few MiB the destination still fits the LLC and regular stores are
+// at least as fast; above it streaming stores match memcpy throughput while
+// leaving the cache to the caller.
+std::atomic<size_t> threshold{4 * 1024 * 1024};
+
+#ifdef VIEW_COPY_HAS_STREAM_STORES
+constexpr size_t vector_size = sizeof(__m128i);
+
+// Handles the unaligned head with a regular store so that every streaming
+// store hits a 16-byte aligned address. Returns the number of head bytes.
+size_t align_head(void* dst, size_t n) {
+  auto misalignment = reinterpret_cast<std::uintptr_t>(dst) % vector_size;
+  return misalignment == 0 ? 0 : std::min(n, vector_size - misalignment);
+}
+#endif
+
+} // namespace
+
+size_t non_temporal_threshold() noexcept {
+  return threshold.load(std::memory_order_relaxed);
+}
+
+void set_non_temporal_threshold(size_t bytes) noexcept {
+  threshold.store(bytes, std::memory_order_relaxed);
+}
+
+void stream_copy_bytes(void* dst, const void* src, size_t n) noexcept {
+#ifdef VIEW_COPY_HAS_STREAM_STORES
+  auto* d = static_cast<unsigned char*>(dst);
+  const auto* s = static_cast<const unsigned char*>(src);
+
+  size_t head = align_head(d, n);
+  std::memcpy(d, s, head);
+  d += head;
+  s += head;
+  n -= head;
+
+  for (; n >= 4 * vector_size; n -= 4 * vector_size, d += 4 * vector_size, s += 4 * vector_size) {
+    const auto* in = reinterpret_cast<const __m128i*>(s);
+    auto* out = reinterpret_cast<__m128i*>(d);
+    __m128i a = _mm_loadu_si128(in);
+    __m128i b = _mm_loadu_si128(in + 1);
+    __m128i c = _mm_loadu_si128(in + 2);
+    __m128i e = _mm_loadu_si128(in + 3);
+    _mm_stream_si128(out, a);
+    _mm_stream_si128(out + 1, b);
+    _mm_stream_si128(out + 2, c);
+    _mm_stream_si128(out + 3, e);
+  }
+  _mm_sfence();
+  std::memcpy(d, s, n);
+#else
+  std::memcpy(dst, src, n);
+#endif
+}
+
+void stream_fill_bytes(void* dst, unsigned char value, size_t n) noexcept {
+#ifdef VIEW_COPY_HAS_STREAM_STORES
+  auto* d = static_cast<unsigned char*>(dst);
+
+  size_t head = align_head(d, n);
+  std::memset(d, value, head);
+  d += head;
+  n -= head;
+
+  __m128i pattern = _mm_set1_epi8(static_cast<char>(value));
+  for (; n >= vector_size; n -= vector_size, d += vector_size) {
+    _mm_stream_si128(reinterpret_cast<__m128i*>(d), pattern);
+  }
+  _mm_sfence();
+  std::memset(d, value, n);
+#else
+  std::memset(dst, value, n);
+#endif
+}
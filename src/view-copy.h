@@ -0,0 +1,121 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Copies of at least this many bytes bypass the cache with non-temporal
+// stores, so that multi-MB transfers do not evict the working set. Tunable at
+// runtime because the crossover depends on the cache size of the machine.
+size_t non_temporal_threshold() noexcept;
+void set_non_temporal_threshold(size_t bytes) noexcept;
+
+// Non-overlapping byte copy / byte fill with streaming stores. Fall back to
+// `memcpy` / `memset` on targets without them.
+void stream_copy_bytes(void* dst, const void* src, size_t n) noexcept;
+void stream_fill_bytes(void* dst, unsigned char value, size_t n) noexcept;
+
+namespace view_copy_detail {
+
+template <size_t N, size_t M>
+constexpr void check_fits() {
+  if constexpr (N != dynamic_extent && M != dynamic_extent) {
+    static_assert(N <= M, "Destination view is smaller than source view");
+  }
+}
+
+template <typename T>
+bool overlap(const T* a, size_t a_size, const T* b, size_t b_size) {
+  return std::less<const T*>{}(a, b + b_size) && std::less<const T*>{}(b, a + a_size);
+}
+
+template <typename T>
+bool uniform_bytes(const T& value) {
+  const auto* bytes = reinterpret_cast<const unsigned char*>(&value);
+  return std::all_of(bytes, bytes + sizeof(T), [&](unsigned char b) { return b == bytes[0]; });
+}
+
+} // namespace view_copy_detail
+
+// Once these are inlined, GCC 12 reports -Wrestrict on the memcpy branches for
+// views it can see overlap, although the overlap checks rule those branches out.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wrestrict"
+#endif
+
+// Copies `src` to the front of `dst` and returns the written prefix. The views
+// must not overlap; use `move_into` otherwise.
+template <typename T, size_t N, typename U, size_t M>
+contiguous_view<U> copy_into(contiguous_view<T, N> src, contiguous_view<U, M> dst) {
+  static_assert(!std::is_const_v<U>, "Destination view must be mutable");
+  static_assert(std::is_assignable_v<U&, const T&>);
+  view_copy_detail::check_fits<N, M>();
+  runtime_assert(src.size() <= dst.size(), "Destination view is smaller than source view.");
+
+  if constexpr (std::is_same_v<std::remove_const_t<T>, U> && std::is_trivially_copyable_v<U>) {
+    // Only the written prefix of `dst` matters.
+    runtime_assert(
+        !view_copy_detail::overlap<U>(src.data(), src.size(), dst.data(), src.size()),
+        "Views passed to copy_into must not overlap."
+    );
+    if (src.size_bytes() >= non_temporal_threshold()) {
+      stream_copy_bytes(dst.data(), src.data(), src.size_bytes());
+    } else if (!src.empty()) {
+      std::memcpy(dst.data(), src.data(), src.size_bytes());
+    }
+  } else {
+    std::copy(src.begin(), src.end(), dst.begin());
+  }
+  return dst.first(src.size());
+}
+
+// Moves `src` to the front of `dst`, which may overlap it.
+template <typename T, size_t N, typename U, size_t M>
+contiguous_view<U> move_into(contiguous_view<T, N> src, contiguous_view<U, M> dst) {
+  static_assert(!std::is_const_v<T> && !std::is_const_v<U>, "Both views must be mutable");
+  view_copy_detail::check_fits<N, M>();
+  runtime_assert(src.size() <= dst.size(), "Destination view is smaller than source view.");
+
+  if constexpr (std::is_same_v<T, U> && std::is_trivially_copyable_v<U>) {
+    if (view_copy_detail::overlap<U>(src.data(), src.size(), dst.data(), src.size())) {
+      std::memmove(dst.data(), src.data(), src.size_bytes());
+    } else if (src.size_bytes() >= non_temporal_threshold()) {
+      stream_copy_bytes(dst.data(), src.data(), src.size_bytes());
+    } else if (!src.empty()) {
+      std::memcpy(dst.data(), src.data(), src.size_bytes());
+    }
+  } else if (std::less<const void*>{}(dst.data(), src.data())) {
+    std::move(src.begin(), src.end(), dst.begin());
+  } else {
+    std::move_backward(src.begin(), src.end(), dst.begin() + src.size());
+  }
+  return dst.first(src.size());
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+template <typename T, size_t N, typename V>
+void fill(contiguous_view<T, N> dst, const V& value) {
+  static_assert(!std::is_const_v<T>, "Destination view must be mutable");
+  if constexpr (std::is_trivially_copyable_v<T> && std::is_convertible_v<const V&, T>) {
+    T converted = value;
+    if (view_copy_detail::uniform_bytes(converted)) {
+      auto byte = *reinterpret_cast<const unsigned char*>(&converted);
+      if (dst.size_bytes() >= non_temporal_threshold()) {
+        stream_fill_bytes(dst.data(), byte, dst.size_bytes());
+      } else if (!dst.empty()) {
+        std::memset(dst.data(), byte, dst.size_bytes());
+      }
+      return;
+    }
+  }
+  std::fill(dst.begin(), dst.end(), value);
+}
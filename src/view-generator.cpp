@@ -0,0 +1,87 @@
+#include "view-generator.h"
+
+#include <algorithm>
+
+void single_thread_executor::post(std::function<void()> task) {
+  std::lock_guard lock(_mutex);
+  _tasks.push_back(std::move(task));
+}
+
+bool single_thread_executor::run_one() {
+  std::function<void()> task;
+  {
+    std::lock_guard lock(_mutex);
+    if (_tasks.empty()) {
+      return false;
+    }
+    task = std::move(_tasks.front());
+    _tasks.pop_front();
+  }
+  task();
+  return true;
+}
+
+void single_thread_executor::run() {
+  while (run_one()) {}
+}
+
+thread_pool_executor::thread_pool_executor(size_t threads) {
+  threads = std::max<size_t>(threads, 1);
+  _workers.reserve(threads);
+  for (size_t i = 0; i < threads; ++i) {
+    _workers.emplace_back([this] {
+      work();
+    });
+  }
+}
+
+thread_pool_executor::~thread_pool_executor() {
+  {
+    std::lock_guard lock(_mutex);
+    _stop = true;
+  }
+  _cv.notify_all();
+  for (auto& worker : _workers) {
+    worker.join();
+  }
+}
+
+void thread_pool_executor::post(std::function<void()> task) {
+  {
+    std::lock_guard lock(_mutex);
+    _tasks.push_back(std::move(task));
+  }
+  _cv.notify_one();
+}
+
+bool thread_pool_executor::run_one() {
+  std::function<void()> task;
+  {
+    std::lock_guard lock(_mutex);
+    if (_tasks.empty()) {
+      return false;
+    }
+    task = std::move(_tasks.front());
+    _tasks.pop_front();
+  }
+  task();
+  return true;
+}
+
+void thread_pool_executor::work() {
+  for (;;) {
+    std::function<void()> task;
+    {
+      std::unique_lock lock(_mutex);
+      _cv.wait(lock, [this] {
+        return _stop || !_tasks.empty();
+      });
+      if (_tasks.empty()) {
+        return;
+      }
+      task = std::move(_tasks.front());
+      _tasks.pop_front();
+    }
+    task();
+  }
+}
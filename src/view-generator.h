@@ -0,0 +1,381 @@
+#pragma once
+
+#include "contiguous-view.h"
+#include "shared-buffer.h"
+
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Lazily evaluated sequence produced by a coroutine that `co_yield`s values.
+// A yielded value is referenced, not copied: it stays valid until the
+// consumer advances, which resumes the coroutine. A coroutine that yields
+// views of a buffer it owns therefore keeps the buffer exactly as long as the
+// consumer looks at the view.
+template <typename T>
+class generator {
+public:
+  struct promise_type {
+    const T* value = nullptr;
+    std::exception_ptr error;
+
+    generator get_return_object() noexcept {
+      return generator(std::coroutine_handle<promise_type>::from_promise(*this));
+    }
+
+    std::suspend_always initial_suspend() const noexcept {
+      return {};
+    }
+
+    std::suspend_always final_suspend() const noexcept {
+      return {};
+    }
+
+    std::suspend_always yield_value(const T& v) noexcept {
+      value = std::addressof(v);
+      return {};
+    }
+
+    void return_void() const noexcept {}
+
+    void unhandled_exception() noexcept {
+      error = std::current_exception();
+    }
+  };
+
+  class iterator {
+  public:
+    using iterator_category = std::input_iterator_tag;
+    using difference_type = std::ptrdiff_t;
+    using value_type = T;
+
+    iterator() noexcept = default;
+
+    const T& operator*() const noexcept {
+      return *_handle.promise().value;
+    }
+
+    const T* operator->() const noexcept {
+      return _handle.promise().value;
+    }
+
+    iterator& operator++() {
+      advance(_handle);
+      return *this;
+    }
+
+    void operator++(int) {
+      ++*this;
+    }
+
+    bool operator==(std::default_sentinel_t) const noexcept {
+      return !_handle || _handle.done();
+    }
+
+  private:
+    friend class generator;
+
+    explicit iterator(std::coroutine_handle<promise_type> handle) noexcept
+        : _handle(handle) {}
+
+    std::coroutine_handle<promise_type> _handle;
+  };
+
+  generator() noexcept = default;
+
+  generator(generator&& other) noexcept
+      : _handle(std::exchange(other._handle, nullptr)) {}
+
+  generator& operator=(generator&& other) noexcept {
+    if (this != &other) {
+      reset();
+      _handle = std::exchange(other._handle, nullptr);
+    }
+    return *this;
+  }
+
+  ~generator() {
+    reset();
+  }
+
+  // Runs the coroutine to its first `co_yield`; call once.
+  iterator begin() {
+    if (_handle) {
+      advance(_handle);
+    }
+    return iterator(_handle);
+  }
+
+  std::default_sentinel_t end() const noexcept {
+    return {};
+  }
+
+private:
+  explicit generator(std::coroutine_handle<promise_type> handle) noexcept
+      : _handle(handle) {}
+
+  static void advance(std::coroutine_handle<promise_type> handle) {
+    handle.resume();
+    if (handle.promise().error) {
+      std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+    }
+  }
+
+  void reset() noexcept {
+    if (_handle) {
+      _handle.destroy();
+      _handle = nullptr;
+    }
+  }
+
+  std::coroutine_handle<promise_type> _handle;
+};
+
+// Runs tasks for asynchronous stages. `run_one` lets a consumer waiting on a
+// stage run queued work itself; it returns false when nothing was queued.
+// Tasks must not throw.
+class executor {
+public:
+  virtual ~executor() = default;
+
+  virtual void post(std::function<void()> task) = 0;
+  virtual bool run_one() = 0;
+};
+
+// Queues tasks and runs them only from `run_one`/`run`, on the calling
+// thread. Stages on it are prefetched in batches when the consumer waits.
+class single_thread_executor final : public executor {
+public:
+  void post(std::function<void()> task) override;
+  bool run_one() override;
+
+  // Runs tasks until the queue is empty.
+  void run();
+
+private:
+  std::mutex _mutex;
+  std::deque<std::function<void()>> _tasks;
+};
+
+// Fixed set of worker threads. The destructor finishes queued tasks before
+// joining; stages running on the pool must be finished or destroyed first.
+class thread_pool_executor final : public executor {
+public:
+  explicit thread_pool_executor(size_t threads = std::thread::hardware_concurrency());
+  ~thread_pool_executor() override;
+
+  thread_pool_executor(const thread_pool_executor&) = delete;
+  thread_pool_executor& operator=(const thread_pool_executor&) = delete;
+
+  void post(std::function<void()> task) override;
+  bool run_one() override;
+
+  size_t threads() const noexcept {
+    return _workers.size();
+  }
+
+private:
+  void work();
+
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<std::function<void()>> _tasks;
+  bool _stop = false;
+  std::vector<std::thread> _workers;
+};
+
+// GCC 12 reports -Wzero-as-null-pointer-constant on the code it generates for
+// every coroutine body.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+#endif
+
+// Allocates chunks of `chunk_size` elements from `pool`, lets `fill` write
+// into them and yields the filled prefix; `fill(contiguous_view<T>)` returns
+// the number of elements written, 0 at the end. A chunk goes back to the pool
+// once every stage holding it has moved on.
+template <typename T, typename Fill>
+generator<shared_buffer<const T>> pooled_chunks(buffer_pool& pool, size_t chunk_size, Fill fill) {
+  for (;;) {
+    auto chunk = shared_buffer<T>::allocate(chunk_size, pool);
+    size_t filled = fill(chunk.view());
+    runtime_assert(filled <= chunk_size, "Fill wrote past the chunk.");
+    if (filled == 0) {
+      co_return;
+    }
+    co_yield shared_buffer<const T>(chunk.slice(0, filled));
+  }
+}
+
+namespace view_generator_detail {
+
+template <typename T>
+struct stage_state {
+  stage_state(generator<shared_buffer<const T>> source, executor& ex, size_t depth)
+      : upstream(std::move(source))
+      , exec(ex)
+      , prefetch_depth(depth) {}
+
+  generator<shared_buffer<const T>> upstream;
+  typename generator<shared_buffer<const T>>::iterator position;
+  bool started = false;
+
+  executor& exec;
+  size_t prefetch_depth;
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  std::deque<shared_buffer<const T>> ready;
+  bool pumping = false;
+  bool done = false;
+  bool cancelled = false;
+  std::exception_ptr error;
+};
+
+// Pulls from upstream until `prefetch_depth` chunks are queued, then stops;
+// the consumer restarts it after taking a chunk. Only one pump runs at a
+// time, so the upstream coroutine is never resumed concurrently.
+template <typename T>
+void pump(const std::shared_ptr<stage_state<T>>& state) {
+  for (;;) {
+    {
+      std::lock_guard lock(state->mutex);
+      if (state->cancelled || state->ready.size() >= state->prefetch_depth) {
+        state->pumping = false;
+        return;
+      }
+    }
+
+    shared_buffer<const T> chunk;
+    bool finished = false;
+    std::exception_ptr error;
+    try {
+      if (!state->started) {
+        state->started = true;
+        state->position = state->upstream.begin();
+      } else {
+        ++state->position;
+      }
+      if (state->position == state->upstream.end()) {
+        finished = true;
+      } else {
+        chunk = *state->position;
+      }
+    } catch (...) {
+      error = std::current_exception();
+      finished = true;
+    }
+
+    std::lock_guard lock(state->mutex);
+    if (finished) {
+      state->done = true;
+      state->error = error;
+      state->pumping = false;
+    } else {
+      state->ready.push_back(std::move(chunk));
+    }
+    state->cv.notify_all();
+    if (finished) {
+      return;
+    }
+  }
+}
+
+template <typename T>
+void schedule(const std::shared_ptr<stage_state<T>>& state) {
+  state->pumping = true;
+  state->exec.post([state] {
+    pump(state);
+  });
+}
+
+} // namespace view_generator_detail
+
+// Runs `upstream` as an asynchronous stage on `ex`, keeping up to
+// `prefetch_depth` chunks ready ahead of the consumer; a full queue stops the
+// producer, which bounds memory. Yields the chunk handles themselves, so the
+// output can feed a transform coroutine and another asynchronous stage: a
+// chain may have any number of async boundaries. The stage drops its
+// reference to a chunk when the consumer resumes it for the next one.
+// Upstream exceptions are rethrown to the consumer.
+template <typename T>
+generator<shared_buffer<const T>> async_buffer_stage(
+    generator<shared_buffer<const T>> upstream,
+    executor& ex,
+    size_t prefetch_depth = 2
+) {
+  using namespace view_generator_detail;
+  runtime_assert(prefetch_depth > 0, "Prefetch depth must be positive.");
+  auto state = std::make_shared<stage_state<T>>(std::move(upstream), ex, prefetch_depth);
+
+  struct cancel_on_exit {
+    std::shared_ptr<stage_state<T>> state;
+
+    ~cancel_on_exit() {
+      std::lock_guard lock(state->mutex);
+      state->cancelled = true;
+    }
+  } guard{state};
+
+  {
+    std::lock_guard lock(state->mutex);
+    schedule(state);
+  }
+
+  for (;;) {
+    shared_buffer<const T> current;
+    {
+      std::unique_lock lock(state->mutex);
+      while (state->ready.empty() && !state->done) {
+        lock.unlock();
+        bool ran = ex.run_one();
+        lock.lock();
+        if (!ran) {
+          state->cv.wait(lock, [&state] {
+            return !state->ready.empty() || state->done;
+          });
+        }
+      }
+      if (state->ready.empty()) {
+        if (state->error) {
+          std::rethrow_exception(state->error);
+        }
+        break;
+      }
+      current = std::move(state->ready.front());
+      state->ready.pop_front();
+      if (!state->pumping && !state->done) {
+        schedule(state);
+      }
+    }
+    co_yield current;
+  }
+}
+
+// `async_buffer_stage` for the end of a chain: yields views of the chunks
+// without copying. A chunk is released, and returns to its pool, when the
+// consumer resumes this generator for the next one.
+template <typename T>
+generator<contiguous_view<const T>> async_stage(
+    generator<shared_buffer<const T>> upstream,
+    executor& ex,
+    size_t prefetch_depth = 2
+) {
+  for (const shared_buffer<const T>& chunk : async_buffer_stage(std::move(upstream), ex, prefetch_depth)) {
+    co_yield chunk.view();
+  }
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,367 @@
+#include "view-instrumentation.h"
+
+#ifdef CONTIGUOUS_VIEW_INSTRUMENTATION
+
+#include "runtime-assert.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <sstream>
+#include <tuple>
+
+namespace view_instrumentation {
+
+namespace {
+
+constexpr size_t unknown_size = static_cast<size_t>(-1);
+
+struct site {
+  std::string file;
+  unsigned line = 0;
+  unsigned column = 0;
+  std::string function;
+  std::array<std::atomic<std::uint64_t>, event_count> counts{};
+  std::array<std::atomic<std::uint64_t>, stride_count> strides{};
+  std::atomic<size_t> size = unknown_size;
+  std::atomic<bool> size_varies = false;
+  std::atomic<bool> dynamic = false;
+};
+
+// Sites are never freed, only zeroed by `reset`, so pointers cached by
+// threads and the owner table stay valid, and live views keep their owner.
+struct registry {
+  std::mutex mutex;
+  std::map<std::tuple<std::string, unsigned, unsigned, std::string>, std::unique_ptr<site>> sites;
+  site* unattributed = nullptr;
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+};
+
+// Leaked so views used during static destruction can still be recorded.
+registry& global() {
+  static registry* r = [] {
+    auto* created = new registry;
+    auto s = std::make_unique<site>();
+    s->file = "<unattributed>";
+    created->unattributed = s.get();
+    created->sites.emplace(std::make_tuple(s->file, 0U, 0U, std::string()), std::move(s));
+    return created;
+  }();
+  return *r;
+}
+
+site& lookup(const std::source_location& loc) {
+  // Keyed by the literal pointers, which are stable per translation unit; the
+  // registry merges identical locations from different ones.
+  using key = std::tuple<const char*, const char*, unsigned, unsigned>;
+  thread_local std::map<key, site*> cache;
+  key k(loc.file_name(), loc.function_name(), loc.line(), loc.column());
+  if (auto it = cache.find(k); it != cache.end()) {
+    return *it->second;
+  }
+
+  auto& r = global();
+  std::lock_guard lock(r.mutex);
+  auto& slot = r.sites[std::make_tuple(
+      std::string(loc.file_name()),
+      static_cast<unsigned>(loc.line()),
+      static_cast<unsigned>(loc.column()),
+      std::string(loc.function_name())
+  )];
+  if (!slot) {
+    slot = std::make_unique<site>();
+    slot->file = loc.file_name();
+    slot->line = loc.line();
+    slot->column = loc.column();
+    slot->function = loc.function_name();
+  }
+  cache.emplace(k, slot.get());
+  return *slot;
+}
+
+void add(std::atomic<std::uint64_t>& counter, std::uint64_t n = 1) {
+  counter.fetch_add(n, std::memory_order_relaxed);
+}
+
+// Direct-mapped table from a view's data pointer to the site that created it.
+// A racing overwrite can only misattribute a sample, so the slot is checked
+// rather than locked.
+struct owner_slot {
+  std::atomic<const void*> data = nullptr;
+  std::atomic<site*> owner = nullptr;
+};
+
+constexpr size_t owner_bits = 12;
+owner_slot owners[size_t{1} << owner_bits];
+
+size_t slot_index(const void* data, size_t bits) {
+  auto key = reinterpret_cast<std::uintptr_t>(data) >> 4;
+  return static_cast<size_t>((static_cast<std::uint64_t>(key) * 0x9E3779B97F4A7C15ULL) >> (64 - bits));
+}
+
+owner_slot& owner_slot_for(const void* data) {
+  return owners[slot_index(data, owner_bits)];
+}
+
+void set_owner(const void* data, site* s) {
+  auto& slot = owner_slot_for(data);
+  slot.data.store(nullptr, std::memory_order_release);
+  slot.owner.store(s, std::memory_order_release);
+  slot.data.store(data, std::memory_order_release);
+}
+
+site& owner_of(const void* data) {
+  auto& slot = owner_slot_for(data);
+  if (slot.data.load(std::memory_order_acquire) == data) {
+    site* s = slot.owner.load(std::memory_order_acquire);
+    if (s && slot.data.load(std::memory_order_acquire) == data) {
+      return *s;
+    }
+  }
+  return *global().unattributed;
+}
+
+std::atomic<size_t> period = 64;
+
+stride classify(std::intptr_t distance, size_t element_size) {
+  auto element = static_cast<std::intptr_t>(element_size);
+  auto magnitude = distance < 0 ? -distance : distance;
+  if (distance == 0) {
+    return stride::same;
+  } else if (distance == element) {
+    return stride::next;
+  } else if (distance == -element) {
+    return stride::previous;
+  } else if (magnitude < 64) {
+    return stride::same_line;
+  } else if (magnitude < 4096) {
+    return stride::same_page;
+  }
+  return stride::far;
+}
+
+constexpr const char* event_names[event_count] = {
+    "view", "subview", "first", "last", "as_bytes", "access", "access_failure", "assert_failure",
+};
+
+constexpr const char* stride_names[stride_count] = {"same", "next", "previous", "same_line", "same_page", "far"};
+
+std::uint64_t weight(const site_stats& s) {
+  std::uint64_t total = 0;
+  for (size_t e = 0; e < event_count; ++e) {
+    total += s.counts[e] * (e == static_cast<size_t>(event::access) ? sample_period() : 1);
+  }
+  return total;
+}
+
+std::string location(const site_stats& s) {
+  return s.file + ":" + std::to_string(s.line) + ":" + std::to_string(s.column);
+}
+
+void write_json_string(std::ostream& out, const std::string& text) {
+  out << '"';
+  for (char c : text) {
+    if (c == '"' || c == '\\') {
+      out << '\\' << c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec
+          << std::setfill(' ');
+    } else {
+      out << c;
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+void record_view(const std::source_location& loc, const void* data, size_t size, bool dynamic) {
+  site& s = lookup(loc);
+  add(s.counts[static_cast<size_t>(event::view)]);
+  size_t expected = unknown_size;
+  if (!s.size.compare_exchange_strong(expected, size, std::memory_order_relaxed) && expected != size) {
+    s.size_varies.store(true, std::memory_order_relaxed);
+  }
+  if (dynamic) {
+    s.dynamic.store(true, std::memory_order_relaxed);
+  }
+  if (data) {
+    set_owner(data, &s);
+  }
+}
+
+void record_event(event kind, const std::source_location& loc) {
+  add(lookup(loc).counts[static_cast<size_t>(kind)]);
+}
+
+void record_access(const void* data, std::uintptr_t address, size_t element_size, bool in_bounds) {
+  // The previous address is kept per view (per data pointer) and thread, so
+  // a loop walking several views measures each one's own stride.
+  struct recent_access {
+    const void* data = nullptr;
+    std::uintptr_t previous = 0;
+  };
+  constexpr size_t recent_bits = 6;
+  thread_local std::uint64_t tick = 0;
+  thread_local recent_access recent[size_t{1} << recent_bits];
+
+  if (!in_bounds) {
+    add(owner_of(data).counts[static_cast<size_t>(event::access_failure)]);
+  }
+  recent_access& last = recent[slot_index(data, recent_bits)];
+  bool first_access = last.data != data;
+  auto distance = static_cast<std::intptr_t>(address - last.previous);
+  last.data = data;
+  last.previous = address;
+  if (++tick % period.load(std::memory_order_relaxed) != 0) {
+    return;
+  }
+
+  site& s = owner_of(data);
+  add(s.counts[static_cast<size_t>(event::access)]);
+  if (!first_access) {
+    add(s.strides[static_cast<size_t>(classify(distance, element_size))]);
+  }
+}
+
+void record_assert_failure(const std::source_location& loc) {
+  add(lookup(loc).counts[static_cast<size_t>(event::assert_failure)]);
+}
+
+size_t sample_period() {
+  return period.load(std::memory_order_relaxed);
+}
+
+void set_sample_period(size_t n) {
+  runtime_assert(n > 0, "Sample period must be positive.");
+  period.store(n, std::memory_order_relaxed);
+}
+
+std::vector<site_stats> snapshot() {
+  auto& r = global();
+  std::lock_guard lock(r.mutex);
+  std::vector<site_stats> result;
+  for (const auto& [key, s] : r.sites) {
+    site_stats stats{s->file, s->line, s->column, s->function, {}, {}, false, 0};
+    bool seen = false;
+    for (size_t e = 0; e < event_count; ++e) {
+      stats.counts[e] = s->counts[e].load(std::memory_order_relaxed);
+      seen |= stats.counts[e] != 0;
+    }
+    for (size_t d = 0; d < stride_count; ++d) {
+      stats.strides[d] = s->strides[d].load(std::memory_order_relaxed);
+    }
+    size_t size = s->size.load(std::memory_order_relaxed);
+    if (size != unknown_size) {
+      stats.size = size;
+      stats.fixed_dynamic_size =
+          s->dynamic.load(std::memory_order_relaxed) && !s->size_varies.load(std::memory_order_relaxed);
+    }
+    if (seen) {
+      result.push_back(std::move(stats));
+    }
+  }
+  return result;
+}
+
+void reset() {
+  auto& r = global();
+  std::lock_guard lock(r.mutex);
+  for (auto& [key, s] : r.sites) {
+    for (auto& c : s->counts) {
+      c.store(0, std::memory_order_relaxed);
+    }
+    for (auto& c : s->strides) {
+      c.store(0, std::memory_order_relaxed);
+    }
+    s->size.store(unknown_size, std::memory_order_relaxed);
+    s->size_varies.store(false, std::memory_order_relaxed);
+    s->dynamic.store(false, std::memory_order_relaxed);
+  }
+  r.start = std::chrono::steady_clock::now();
+}
+
+void write_report(std::ostream& out) {
+  constexpr int column = 12;
+  auto sites = snapshot();
+  std::stable_sort(sites.begin(), sites.end(), [](const site_stats& a, const site_stats& b) {
+    return weight(a) > weight(b);
+  });
+
+  out << "contiguous_view call sites, busiest first (accesses sampled 1 in " << sample_period() << ")\n";
+  out << std::setw(column) << "views" << std::setw(column) << "subviews" << std::setw(column) << "first/last"
+      << std::setw(column) << "as_bytes" << std::setw(column) << "accesses" << std::setw(column) << "failures"
+      << "  site\n";
+  for (const auto& s : sites) {
+    auto count = [&s](event e) {
+      return s.counts[static_cast<size_t>(e)];
+    };
+    out << std::setw(column) << count(event::view) << std::setw(column) << count(event::subview) << std::setw(column)
+        << count(event::first) + count(event::last) << std::setw(column) << count(event::as_bytes) << std::setw(column)
+        << count(event::access) << std::setw(column) << count(event::access_failure) + count(event::assert_failure)
+        << "  " << location(s) << " " << s.function << "\n";
+
+    std::uint64_t strided = 0;
+    for (auto n : s.strides) {
+      strided += n;
+    }
+    if (strided > 0) {
+      out << std::string(column, ' ') << "strides:";
+      for (size_t d = 0; d < stride_count; ++d) {
+        if (s.strides[d] != 0) {
+          out << " " << stride_names[d] << " " << s.strides[d] * 100 / strided << "%";
+        }
+      }
+      out << "\n";
+    }
+
+    if (s.fixed_dynamic_size && count(event::view) > 1) {
+      out << std::string(column, ' ') << "hint: every view here has " << s.size
+          << " elements; a static extent would drop the size and its checks\n";
+    }
+    auto sequential = s.strides[static_cast<size_t>(stride::next)] + s.strides[static_cast<size_t>(stride::previous)];
+    bool failed = count(event::access_failure) + count(event::assert_failure) > 0;
+    if (strided >= 16 && sequential * 10 >= strided * 9 && !failed) {
+      out << std::string(column, ' ')
+          << "hint: accesses are sequential and never out of bounds; iterate or check once and access unchecked\n";
+    }
+  }
+}
+
+std::string report() {
+  std::ostringstream out;
+  write_report(out);
+  return out.str();
+}
+
+void write_trace(std::ostream& out) {
+  auto sites = snapshot();
+  auto elapsed = std::chrono::steady_clock::now() - global().start;
+  auto ts = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+
+  out << "{\"traceEvents\":[";
+  bool first_event = true;
+  for (const auto& s : sites) {
+    out << (first_event ? "\n" : ",\n") << "{\"name\":";
+    first_event = false;
+    write_json_string(out, location(s));
+    out << ",\"cat\":\"contiguous_view\",\"ph\":\"C\",\"ts\":" << ts << ",\"pid\":0,\"tid\":0,\"args\":{";
+    for (size_t e = 0; e < event_count; ++e) {
+      out << (e ? "," : "") << "\"" << event_names[e] << "\":" << s.counts[e];
+    }
+    for (size_t d = 0; d < stride_count; ++d) {
+      out << ",\"stride_" << stride_names[d] << "\":" << s.strides[d];
+    }
+    out << "}}";
+  }
+  out << "\n],\"displayTimeUnit\":\"ns\",\"otherData\":{\"sample_period\":" << sample_period() << "}}\n";
+}
+
+} // namespace view_instrumentation
+
+#endif
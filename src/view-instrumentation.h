@@ -0,0 +1,110 @@
+#pragma once
+
+// Opt-in instrumentation of contiguous_view, enabled by defining
+// CONTIGUOUS_VIEW_INSTRUMENTATION (the USE_VIEW_INSTRUMENTATION CMake
+// option). Without it the hooks below expand to nothing and the view keeps
+// its usual signatures and layout.
+//
+// With it, view constructors, subview/first/last and as_bytes take a
+// defaulted std::source_location, so every event is counted against the line
+// that caused it; failed runtime_asserts are counted the same way. Operators
+// cannot take default arguments, so `operator[]` is attributed through a
+// small table mapping a view's data pointer to the site that created it, and
+// only every `sample_period()`-th access on a thread is recorded, together
+// with its distance from the previous access on that thread.
+
+#ifdef CONTIGUOUS_VIEW_INSTRUMENTATION
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <source_location>
+#include <string>
+#include <vector>
+
+namespace view_instrumentation {
+
+enum class event : unsigned {
+  view,
+  subview,
+  first,
+  last,
+  as_bytes,
+  access,
+  access_failure,
+  assert_failure,
+};
+
+inline constexpr size_t event_count = 8;
+
+// Distance from the previous sampled thread's access, relative to the element.
+enum class stride : unsigned {
+  same,
+  next,
+  previous,
+  same_line,
+  same_page,
+  far,
+};
+
+inline constexpr size_t stride_count = 6;
+
+struct site_stats {
+  std::string file;
+  unsigned line;
+  unsigned column;
+  std::string function;
+  std::array<std::uint64_t, event_count> counts;
+  std::array<std::uint64_t, stride_count> strides;
+  // Set when every view created here had the same size and a dynamic extent.
+  bool fixed_dynamic_size;
+  size_t size;
+};
+
+// A view of `size` elements at `data` was constructed for `site`.
+void record_view(const std::source_location& site, const void* data, size_t size, bool dynamic);
+
+void record_event(event kind, const std::source_location& site);
+
+void record_access(const void* data, std::uintptr_t address, size_t element_size, bool in_bounds);
+
+void record_assert_failure(const std::source_location& site);
+
+size_t sample_period();
+void set_sample_period(size_t period);
+
+std::vector<site_stats> snapshot();
+void reset();
+
+// Human-readable table, busiest sites first, with hints where a static extent
+// or unchecked access looks worthwhile.
+void write_report(std::ostream& out);
+std::string report();
+
+// Chrome trace-event JSON (loadable by Perfetto and chrome://tracing): one
+// counter event per site.
+void write_trace(std::ostream& out);
+
+} // namespace view_instrumentation
+
+#define VIEW_SITE_PARAM , std::source_location site = std::source_location::current()
+#define VIEW_SITE_ONLY_PARAM std::source_location site = std::source_location::current()
+#define VIEW_SITE_ARG , site
+#define VIEW_RECORD_VIEW(data, size, dynamic) view_instrumentation::record_view(site, data, size, dynamic)
+#define VIEW_RECORD(kind) view_instrumentation::record_event(view_instrumentation::event::kind, site)
+#define VIEW_RECORD_ACCESS(data, idx, element_size, in_bounds)                                                    \
+  view_instrumentation::record_access(                                                                            \
+      data, reinterpret_cast<std::uintptr_t>(data) + (idx) * (element_size), element_size, in_bounds              \
+  )
+
+#else
+
+#define VIEW_SITE_PARAM
+#define VIEW_SITE_ONLY_PARAM
+#define VIEW_SITE_ARG
+#define VIEW_RECORD_VIEW(data, size, dynamic) static_cast<void>(0)
+#define VIEW_RECORD(kind) static_cast<void>(0)
+#define VIEW_RECORD_ACCESS(data, idx, element_size, in_bounds) static_cast<void>(0)
+
+#endif
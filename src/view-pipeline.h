@@ -0,0 +1,268 @@
+#pragma once
+
+#include "contiguous-view.h"
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+// Expression templates over read-only contiguous views. Every stage only
+// describes how to compute element `i`; the terminal operation (`reduce`,
+// `sum`, `count`, `store_into`) runs a single loop over the whole chain, so no
+// temporaries are materialized. When the extent is static, the loop bound is a
+// compile-time constant.
+//
+// `visit(i, sink)` computes element `i` once and passes it down the chain;
+// `where` only forwards values its predicate accepts, so each functor runs at
+// most once per element.
+
+namespace pipeline_detail {
+
+constexpr size_t common_extent(size_t a, size_t b) {
+  return a == dynamic_extent ? b : a;
+}
+
+} // namespace pipeline_detail
+
+template <typename Derived>
+class pipeline_expr;
+
+template <typename T, size_t Extent>
+class source_expr;
+
+template <typename Expr, typename F>
+class map_expr;
+
+template <typename Lhs, typename Rhs, typename F>
+class zip_expr;
+
+template <typename Expr, typename Pred>
+class where_expr;
+
+template <typename T, size_t Extent>
+source_expr<std::remove_const_t<T>, Extent> pipeline(contiguous_view<T, Extent> view);
+
+template <typename T>
+struct is_pipeline_expr : std::is_base_of<pipeline_expr<T>, T> {};
+
+template <typename Derived>
+class pipeline_expr {
+  const Derived& self() const {
+    return static_cast<const Derived&>(*this);
+  }
+
+  template <typename Body>
+  void run(Body&& body) const {
+    const Derived& e = self();
+    if constexpr (Derived::extent != dynamic_extent) {
+      for (size_t i = 0; i < Derived::extent; ++i) {
+        body(e, i);
+      }
+    } else {
+      size_t n = e.size();
+      for (size_t i = 0; i < n; ++i) {
+        body(e, i);
+      }
+    }
+  }
+
+public:
+  template <typename F>
+  auto map(F f) const {
+    return map_expr<Derived, F>(self(), std::move(f));
+  }
+
+  template <typename Other, typename F>
+  auto zip_with(const Other& other, F f) const {
+    if constexpr (is_pipeline_expr<Other>::value) {
+      return zip_expr<Derived, Other, F>(self(), other, std::move(f));
+    } else {
+      return zip_with(pipeline(other), std::move(f));
+    }
+  }
+
+  template <typename Pred>
+  auto where(Pred pred) const {
+    return where_expr<Derived, Pred>(self(), std::move(pred));
+  }
+
+  template <typename Acc, typename Op>
+  Acc reduce(Acc init, Op op) const {
+    Acc acc = std::move(init);
+    run([&](const Derived& e, size_t i) {
+      e.visit(i, [&](auto&& v) {
+        acc = op(std::move(acc), std::forward<decltype(v)>(v));
+      });
+    });
+    return acc;
+  }
+
+  auto sum() const {
+    return reduce(typename Derived::value_type{}, std::plus<>{});
+  }
+
+  size_t count() const {
+    if constexpr (Derived::filtered) {
+      size_t result = 0;
+      run([&](const Derived& e, size_t i) {
+        e.visit(i, [&](auto&&) {
+          ++result;
+        });
+      });
+      return result;
+    } else {
+      return self().size();
+    }
+  }
+
+  // Writes the surviving elements to the front of `out` and returns how many
+  // were written. Without `where` the output must match the input exactly.
+  template <typename U, size_t N>
+  size_t store_into(contiguous_view<U, N> out) const {
+    static_assert(!std::is_const_v<U>, "Output view must be mutable");
+    if constexpr (Derived::extent != dynamic_extent && N != dynamic_extent) {
+      static_assert(Derived::filtered ? N >= Derived::extent : N == Derived::extent, "Output extent mismatch");
+    }
+    U* dst = out.data();
+    if constexpr (Derived::filtered) {
+      runtime_assert(out.size() >= self().size(), "Output must be able to hold every input element.");
+      size_t written = 0;
+      run([&](const Derived& e, size_t i) {
+        e.visit(i, [&](auto&& v) {
+          dst[written++] = std::forward<decltype(v)>(v);
+        });
+      });
+      return written;
+    } else {
+      runtime_assert(out.size() == self().size(), "Output size must match pipeline size.");
+      run([&](const Derived& e, size_t i) {
+        e.visit(i, [&](auto&& v) {
+          dst[i] = std::forward<decltype(v)>(v);
+        });
+      });
+      return self().size();
+    }
+  }
+};
+
+template <typename T, size_t Extent>
+class source_expr : public pipeline_expr<source_expr<T, Extent>> {
+  const T* _data;
+  [[no_unique_address]] sizer<Extent> _size;
+
+public:
+  using value_type = T;
+  static constexpr size_t extent = Extent;
+  static constexpr bool filtered = false;
+
+  explicit source_expr(contiguous_view<const T, Extent> view)
+      : _data(view.data())
+      , _size(view.size()) {}
+
+  size_t size() const {
+    return _size.size();
+  }
+
+  template <typename Sink>
+  void visit(size_t i, Sink&& sink) const {
+    sink(_data[i]);
+  }
+};
+
+template <typename Expr, typename F>
+class map_expr : public pipeline_expr<map_expr<Expr, F>> {
+  Expr _inner;
+  [[no_unique_address]] F _f;
+
+public:
+  using value_type = std::remove_cvref_t<std::invoke_result_t<const F&, const typename Expr::value_type&>>;
+  static constexpr size_t extent = Expr::extent;
+  static constexpr bool filtered = Expr::filtered;
+
+  map_expr(const Expr& inner, F f)
+      : _inner(inner)
+      , _f(std::move(f)) {}
+
+  size_t size() const {
+    return _inner.size();
+  }
+
+  template <typename Sink>
+  void visit(size_t i, Sink&& sink) const {
+    _inner.visit(i, [&](auto&& v) {
+      sink(_f(std::forward<decltype(v)>(v)));
+    });
+  }
+};
+
+template <typename Lhs, typename Rhs, typename F>
+class zip_expr : public pipeline_expr<zip_expr<Lhs, Rhs, F>> {
+  static_assert(
+      Lhs::extent == dynamic_extent || Rhs::extent == dynamic_extent || Lhs::extent == Rhs::extent,
+      "Zipped pipelines must have the same extent"
+  );
+
+  Lhs _lhs;
+  Rhs _rhs;
+  [[no_unique_address]] F _f;
+
+public:
+  using value_type = std::remove_cvref_t<
+      std::invoke_result_t<const F&, const typename Lhs::value_type&, const typename Rhs::value_type&>>;
+  static constexpr size_t extent = pipeline_detail::common_extent(Lhs::extent, Rhs::extent);
+  static constexpr bool filtered = Lhs::filtered || Rhs::filtered;
+
+  zip_expr(const Lhs& lhs, const Rhs& rhs, F f)
+      : _lhs(lhs)
+      , _rhs(rhs)
+      , _f(std::move(f)) {
+    runtime_assert(lhs.size() == rhs.size(), "Zipped pipelines must have the same size.");
+  }
+
+  size_t size() const {
+    return _lhs.size();
+  }
+
+  template <typename Sink>
+  void visit(size_t i, Sink&& sink) const {
+    _lhs.visit(i, [&](auto&& a) {
+      _rhs.visit(i, [&](auto&& b) {
+        sink(_f(std::forward<decltype(a)>(a), std::forward<decltype(b)>(b)));
+      });
+    });
+  }
+};
+
+template <typename Expr, typename Pred>
+class where_expr : public pipeline_expr<where_expr<Expr, Pred>> {
+  Expr _inner;
+  [[no_unique_address]] Pred _pred;
+
+public:
+  using value_type = typename Expr::value_type;
+  static constexpr size_t extent = Expr::extent;
+  static constexpr bool filtered = true;
+
+  where_expr(const Expr& inner, Pred pred)
+      : _inner(inner)
+      , _pred(std::move(pred)) {}
+
+  size_t size() const {
+    return _inner.size();
+  }
+
+  template <typename Sink>
+  void visit(size_t i, Sink&& sink) const {
+    _inner.visit(i, [&](auto&& v) {
+      if (_pred(std::as_const(v))) {
+        sink(std::forward<decltype(v)>(v));
+      }
+    });
+  }
+};
+
+template <typename T, size_t Extent>
+source_expr<std::remove_const_t<T>, Extent> pipeline(contiguous_view<T, Extent> view) {
+  return source_expr<std::remove_const_t<T>, Extent>(view);
+}
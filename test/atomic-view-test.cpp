@@ -0,0 +1,156 @@
+#include "atomic-view.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+TEST(atomic_view_tests, load_store) {
+  std::array<int, 3> a{1, 2, 3};
+  atomic_view v(contiguous_view<int, 3>(a.begin(), a.end()));
+
+  EXPECT_EQ(v.size(), 3);
+  EXPECT_EQ(v.load(1), 2);
+
+  v.store(1, 42, std::memory_order_release);
+  EXPECT_EQ(v.load(1, std::memory_order_acquire), 42);
+  EXPECT_EQ(a[1], 42);
+
+  EXPECT_EQ(v.exchange(2, 7), 3);
+  EXPECT_EQ(a[2], 7);
+}
+
+TEST(atomic_view_tests, fetch_ops) {
+  std::array<std::uint32_t, 2> a{10, 0b1100};
+  atomic_view<std::uint32_t> v(contiguous_view<std::uint32_t>(a.begin(), a.end()));
+
+  EXPECT_EQ(v.fetch_add(0, 5), 10);
+  EXPECT_EQ(v.fetch_sub(0, 3, std::memory_order_relaxed), 15);
+  EXPECT_EQ(a[0], 12);
+
+  EXPECT_EQ(v.fetch_or(1, 0b0011), 0b1100);
+  EXPECT_EQ(v.fetch_and(1, 0b0101), 0b1111);
+  EXPECT_EQ(a[1], 0b0101);
+}
+
+TEST(atomic_view_tests, compare_exchange) {
+  std::array<int, 1> a{5};
+  atomic_view<int> v(contiguous_view<int>(a.begin(), a.end()));
+
+  int expected = 4;
+  EXPECT_FALSE(v.compare_exchange_strong(0, expected, 9));
+  EXPECT_EQ(expected, 5);
+  EXPECT_TRUE(v.compare_exchange_strong(0, expected, 9, std::memory_order_acq_rel, std::memory_order_acquire));
+  EXPECT_EQ(a[0], 9);
+
+  expected = 9;
+  while (!v.compare_exchange_weak(0, expected, 11)) {}
+  EXPECT_EQ(a[0], 11);
+}
+
+TEST(atomic_view_tests, concurrent_fetch_add) {
+  std::vector<std::uint64_t> counters(4);
+  atomic_view<std::uint64_t> v(contiguous_view<std::uint64_t>(counters.begin(), counters.end()));
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([v] {
+      for (int i = 0; i < 1000; ++i) {
+        v.fetch_add(static_cast<size_t>(i) % 4, 1, std::memory_order_relaxed);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  for (auto c : counters) {
+    EXPECT_EQ(c, 1000);
+  }
+}
+
+TEST(atomic_view_tests, subview) {
+  std::array<int, 4> a{1, 2, 3, 4};
+  atomic_view<int> v(contiguous_view<int>(a.begin(), a.end()));
+
+  auto sub = v.subview(1, 2);
+  EXPECT_EQ(sub.size(), 2);
+  EXPECT_EQ(sub.load(0), 2);
+  EXPECT_EQ(sub.view().data(), a.data() + 1);
+}
+
+TEST(atomic_view_tests, out_of_range) {
+  std::vector<int> a{1, 2};
+  atomic_view<int> v(contiguous_view<int>(a.begin(), a.end()));
+
+  // volatile keeps GCC from flagging the (never executed) out-of-bounds atomic access
+  volatile size_t idx = v.size();
+  EXPECT_THROW(v.load(idx), assertion_error);
+  EXPECT_THROW(v.store(idx + 3, 0), assertion_error);
+}
+
+TEST(striped_histogram_tests, shards_are_cache_line_aligned) {
+  striped_histogram<> h(3, 4);
+
+  EXPECT_EQ(h.shards(), 4);
+  for (size_t s = 0; s < h.shards(); ++s) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(h.shard(s).view().data()) % cache_line_size, 0);
+  }
+  EXPECT_THROW(h.shard(4), assertion_error);
+  EXPECT_THROW(h.add_to_shard(4, 0), assertion_error);
+  EXPECT_THROW(h.add_to_shard(0, 3), assertion_error);
+}
+
+TEST(striped_histogram_tests, concurrent_merge) {
+  striped_histogram<> h(10, 4);
+
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&h, t] {
+      for (size_t i = 0; i < 1000; ++i) {
+        h.add_to_shard(t, i % 10);
+      }
+      h.add(9, 5);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::vector<std::uint64_t> out(10);
+  h.merge_into(contiguous_view<std::uint64_t>(out.begin(), out.end()));
+  for (size_t i = 0; i < 9; ++i) {
+    EXPECT_EQ(out[i], 400);
+  }
+  EXPECT_EQ(out[9], 420);
+
+  h.clear();
+  h.merge_into(contiguous_view<std::uint64_t>(out.begin(), out.end()));
+  EXPECT_EQ(out[9], 0);
+}
+
+TEST(striped_histogram_tests, threads_get_distinct_shards) {
+  striped_histogram<> h(1, 4);
+
+  std::array<size_t, 4> shards{};
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < shards.size(); ++t) {
+    threads.emplace_back([&h, &shards, t] {
+      shards[t] = h.shard_for_this_thread();
+      EXPECT_EQ(h.shard_for_this_thread(), shards[t]);
+      h.add(0);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+
+  std::sort(shards.begin(), shards.end());
+  EXPECT_EQ(std::unique(shards.begin(), shards.end()), shards.end());
+  for (size_t s = 0; s < h.shards(); ++s) {
+    EXPECT_EQ(h.shard(s).load(0), 1);
+  }
+}
@@ -0,0 +1,111 @@
+#include "checksum.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+byte_view bytes(const std::string& s) {
+  return byte_view(reinterpret_cast<const std::byte*>(s.data()), s.size());
+}
+
+std::vector<std::byte> random_bytes(size_t n, unsigned seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::byte> data(n);
+  for (auto& b : data) {
+    b = static_cast<std::byte>(rng());
+  }
+  return data;
+}
+
+// Bit-at-a-time reference for a reflected CRC with inverted init and output.
+template <typename U>
+U reference_crc(byte_view data, U poly) {
+  U crc = ~U(0);
+  for (std::byte b : data) {
+    crc ^= static_cast<U>(b);
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = crc & 1 ? (crc >> 1) ^ poly : crc >> 1;
+    }
+  }
+  return ~crc;
+}
+
+} // namespace
+
+TEST(checksum_tests, check_values) {
+  std::string check = "123456789";
+
+  EXPECT_EQ(crc32c(bytes(check)), 0xE3069283u);
+  EXPECT_EQ(crc32(bytes(check)), 0xCBF43926u);
+  EXPECT_EQ(crc64(bytes(check)), 0x995DC9BBDF1939FAull);
+  EXPECT_EQ(crc32c_portable(bytes(check)), 0xE3069283u);
+  EXPECT_EQ(crc32_portable(bytes(check)), 0xCBF43926u);
+  EXPECT_EQ(crc64_portable(bytes(check)), 0x995DC9BBDF1939FAull);
+
+  EXPECT_EQ(crc32c(byte_view()), 0u);
+  EXPECT_EQ(crc64(byte_view()), 0u);
+}
+
+TEST(checksum_tests, matches_reference_for_all_lengths) {
+  auto data = random_bytes(40000, 1);
+  byte_view all(data.data(), data.size());
+
+  // Covers the scalar tails, the 64-byte folding loop and the three-way
+  // interleaved blocks, at unaligned starting offsets.
+  for (size_t n : {0u, 1u, 7u, 15u, 16u, 63u, 64u, 65u, 127u, 128u, 1000u, 12287u, 12288u, 12289u, 39990u}) {
+    for (size_t offset : {0u, 3u}) {
+      auto v = all.subview(offset, n);
+      EXPECT_EQ(crc32c(v), reference_crc<std::uint32_t>(v, 0x82F63B78)) << n;
+      EXPECT_EQ(crc32(v), reference_crc<std::uint32_t>(v, 0xEDB88320)) << n;
+      EXPECT_EQ(crc64(v), reference_crc<std::uint64_t>(v, 0xC96C5795D7870F42)) << n;
+      EXPECT_EQ(crc32c_portable(v), crc32c(v)) << n;
+      EXPECT_EQ(crc32_portable(v), crc32(v)) << n;
+      EXPECT_EQ(crc64_portable(v), crc64(v)) << n;
+    }
+  }
+}
+
+TEST(checksum_tests, incremental_update) {
+  auto data = random_bytes(20000, 2);
+  byte_view all(data.data(), data.size());
+
+  std::uint32_t c = 0;
+  std::uint32_t c32 = 0;
+  std::uint64_t c64 = 0;
+  for (size_t pos = 0, step = 1; pos < all.size(); pos += step, step = step * 3 + 1) {
+    auto chunk = all.subview(pos, std::min(step, all.size() - pos));
+    c = crc32c(chunk, c);
+    c32 = crc32(chunk, c32);
+    c64 = crc64(chunk, c64);
+  }
+  EXPECT_EQ(c, crc32c(all));
+  EXPECT_EQ(c32, crc32(all));
+  EXPECT_EQ(c64, crc64(all));
+}
+
+TEST(checksum_tests, combine_subviews) {
+  auto data = random_bytes(50000, 3);
+  byte_view all(data.data(), data.size());
+
+  for (size_t split : {0u, 1u, 100u, 4096u, 25000u, 49999u, 50000u}) {
+    auto a = all.first(split);
+    auto b = all.subview(split);
+    EXPECT_EQ(crc32c_combine(crc32c(a), crc32c(b), b.size()), crc32c(all)) << split;
+    EXPECT_EQ(crc32_combine(crc32(a), crc32(b), b.size()), crc32(all)) << split;
+    EXPECT_EQ(crc64_combine(crc64(a), crc64(b), b.size()), crc64(all)) << split;
+  }
+
+  // Fold per-chunk checksums left to right, as a parallel reduction would.
+  constexpr size_t chunk = 7000;
+  std::uint32_t combined = crc32c(all.first(chunk));
+  for (size_t pos = chunk; pos < all.size(); pos += chunk) {
+    auto part = all.subview(pos, std::min(chunk, all.size() - pos));
+    combined = crc32c_combine(combined, crc32c(part), part.size());
+  }
+  EXPECT_EQ(combined, crc32c(all));
+}
@@ -0,0 +1,156 @@
+#include "gather.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<std::uint32_t> random_indices(size_t n, size_t limit, std::uint32_t seed) {
+  std::mt19937 rng(seed);
+  std::vector<std::uint32_t> idx(n);
+  for (auto& i : idx) {
+    i = static_cast<std::uint32_t>(rng() % limit);
+  }
+  return idx;
+}
+
+} // namespace
+
+TEST(gather_tests, gather) {
+  std::vector<std::uint64_t> in(1000);
+  std::iota(in.begin(), in.end(), 100);
+  auto idx = random_indices(777, in.size(), 1);
+  std::vector<std::uint64_t> out(idx.size());
+
+  gather(
+      contiguous_view<const std::uint64_t>(in.begin(), in.end()),
+      contiguous_view<const std::uint32_t>(idx.begin(), idx.end()),
+      contiguous_view<std::uint64_t>(out.begin(), out.end())
+  );
+
+  for (size_t i = 0; i < idx.size(); ++i) {
+    ASSERT_EQ(out[i], in[idx[i]]);
+  }
+}
+
+TEST(gather_tests, gather_sorted) {
+  std::vector<float> in(1000);
+  std::iota(in.begin(), in.end(), 0.5f);
+  std::vector<std::uint32_t> idx(300);
+  for (size_t i = 0; i < idx.size(); ++i) {
+    idx[i] = static_cast<std::uint32_t>(i * 3);
+  }
+  std::vector<float> out(idx.size());
+
+  gather(
+      contiguous_view<const float>(in.begin(), in.end()),
+      contiguous_view<const std::uint32_t>(idx.begin(), idx.end()),
+      contiguous_view<float>(out.begin(), out.end()),
+      {.prefetch_distance = 0, .sorted_indices = true}
+  );
+
+  for (size_t i = 0; i < idx.size(); ++i) {
+    ASSERT_EQ(out[i], in[idx[i]]);
+  }
+}
+
+TEST(gather_tests, sorted_blocks_with_runs_gaps_and_duplicates) {
+  // Spans several cache blocks: dense runs, sparse stretches, repeated
+  // indices and a jump over whole blocks.
+  std::vector<std::uint32_t> in(40000);
+  std::iota(in.begin(), in.end(), 7u);
+  std::vector<std::uint32_t> idx;
+  for (std::uint32_t i = 0; i < 5000; ++i) {
+    idx.push_back(i);
+  }
+  for (std::uint32_t i = 5000; i < 12000; i += 5) {
+    idx.push_back(i);
+    idx.push_back(i);
+  }
+  for (std::uint32_t i = 30000; i < 40000; ++i) {
+    idx.push_back(i);
+  }
+  std::vector<std::uint32_t> out(idx.size());
+
+  gather(
+      contiguous_view<const std::uint32_t>(in.begin(), in.end()),
+      contiguous_view<const std::uint32_t>(idx.begin(), idx.end()),
+      contiguous_view<std::uint32_t>(out.begin(), out.end()),
+      {.sorted_indices = true}
+  );
+  for (size_t i = 0; i < idx.size(); ++i) {
+    ASSERT_EQ(out[i], in[idx[i]]);
+  }
+
+  // Scatter back through strictly increasing indices.
+  std::vector<std::uint32_t> unique(idx.begin(), idx.end());
+  unique.erase(std::unique(unique.begin(), unique.end()), unique.end());
+  std::vector<std::uint32_t> values(unique.size());
+  std::iota(values.begin(), values.end(), 1u);
+  std::vector<std::uint32_t> target(in.size(), 0);
+  scatter(
+      contiguous_view<const std::uint32_t>(values.begin(), values.end()),
+      contiguous_view<const std::uint32_t>(unique.begin(), unique.end()),
+      contiguous_view<std::uint32_t>(target.begin(), target.end()),
+      {.sorted_indices = true}
+  );
+  for (size_t i = 0; i < unique.size(); ++i) {
+    ASSERT_EQ(target[unique[i]], values[i]);
+  }
+  EXPECT_EQ(std::count(target.begin(), target.end(), 0u), target.size() - unique.size());
+}
+
+TEST(gather_tests, scatter) {
+  std::vector<std::uint32_t> in(500);
+  std::iota(in.begin(), in.end(), 7);
+  std::vector<std::uint32_t> idx(in.size());
+  std::iota(idx.begin(), idx.end(), 0);
+  std::shuffle(idx.begin(), idx.end(), std::mt19937(2));
+  std::vector<std::uint32_t> out(in.size());
+
+  scatter(
+      contiguous_view<const std::uint32_t>(in.begin(), in.end()),
+      contiguous_view<const std::uint32_t>(idx.begin(), idx.end()),
+      contiguous_view<std::uint32_t>(out.begin(), out.end())
+  );
+
+  for (size_t i = 0; i < idx.size(); ++i) {
+    ASSERT_EQ(out[idx[i]], in[i]);
+  }
+}
+
+TEST(gather_tests, apply_permutation) {
+  std::vector<int> data{10, 20, 30, 40};
+  std::vector<std::uint32_t> perm{3, 0, 2, 1};
+  std::vector<int> scratch(4);
+
+  apply_permutation(
+      contiguous_view<int>(data.begin(), data.end()),
+      contiguous_view<const std::uint32_t>(perm.begin(), perm.end()),
+      contiguous_view<int>(scratch.begin(), scratch.end())
+  );
+
+  EXPECT_EQ(data, (std::vector<int>{40, 10, 30, 20}));
+}
+
+#ifndef NDEBUG
+TEST(gather_tests, out_of_range_index) {
+  std::vector<int> in(10);
+  std::vector<std::uint32_t> idx{1, 2, 10};
+  std::vector<int> out(3);
+
+  EXPECT_THROW(
+      gather(
+          contiguous_view<const int>(in.begin(), in.end()),
+          contiguous_view<const std::uint32_t>(idx.begin(), idx.end()),
+          contiguous_view<int>(out.begin(), out.end())
+      ),
+      assertion_error
+  );
+}
+#endif
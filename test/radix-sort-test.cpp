@@ -0,0 +1,125 @@
+#include "radix-sort.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+template <typename T>
+void expect_sorts(std::vector<T> values) {
+  std::vector<T> expected = values;
+  std::stable_sort(expected.begin(), expected.end());
+  std::vector<T> scratch(values.size());
+
+  radix_sort(contiguous_view<T>(values.begin(), values.end()), contiguous_view<T>(scratch.begin(), scratch.end()));
+
+  EXPECT_EQ(values, expected);
+}
+
+template <typename T>
+std::vector<T> random_values(size_t n, std::uint64_t seed) {
+  std::mt19937_64 rng(seed);
+  std::vector<T> values(n);
+  for (auto& v : values) {
+    v = static_cast<T>(rng());
+  }
+  return values;
+}
+
+} // namespace
+
+TEST(radix_sort_tests, unsigned_integers) {
+  expect_sorts(random_values<std::uint64_t>(1000, 1));
+  expect_sorts(random_values<std::uint8_t>(1000, 2));
+  expect_sorts(std::vector<std::uint32_t>{});
+  expect_sorts(std::vector<std::uint32_t>{42});
+}
+
+TEST(radix_sort_tests, signed_integers) {
+  auto values = random_values<std::int32_t>(1000, 3);
+  values.push_back(std::numeric_limits<std::int32_t>::min());
+  values.push_back(std::numeric_limits<std::int32_t>::max());
+  values.push_back(0);
+  values.push_back(-1);
+  expect_sorts(values);
+}
+
+TEST(radix_sort_tests, floats) {
+  std::mt19937 rng(4);
+  std::uniform_real_distribution<double> dist(-1e6, 1e6);
+  std::vector<double> doubles(1000);
+  for (auto& d : doubles) {
+    d = dist(rng);
+  }
+  doubles.push_back(-0.0);
+  doubles.push_back(std::numeric_limits<double>::infinity());
+  doubles.push_back(-std::numeric_limits<double>::infinity());
+  expect_sorts(doubles);
+
+  std::vector<float> floats{3.5f, -2.25f, 0.0f, -100.0f, 1e-30f, -1e-30f};
+  expect_sorts(floats);
+}
+
+TEST(radix_sort_tests, key_extractor_is_stable) {
+  struct record {
+    std::uint16_t key;
+    std::string payload;
+  };
+
+  std::vector<record> records;
+  for (int i = 0; i < 500; ++i) {
+    records.push_back({static_cast<std::uint16_t>((i * 7919) % 37), std::to_string(i)});
+  }
+  std::vector<record> expected = records;
+  std::stable_sort(expected.begin(), expected.end(), [](const record& a, const record& b) { return a.key < b.key; });
+  std::vector<record> scratch(records.size());
+
+  radix_sort(
+      contiguous_view<record>(records.begin(), records.end()),
+      contiguous_view<record>(scratch.begin(), scratch.end()),
+      [](const record& r) { return r.key; }
+  );
+
+  for (size_t i = 0; i < records.size(); ++i) {
+    EXPECT_EQ(records[i].key, expected[i].key);
+    EXPECT_EQ(records[i].payload, expected[i].payload);
+  }
+}
+
+TEST(radix_sort_tests, multi_threaded) {
+  auto values = random_values<std::uint32_t>(100000, 5);
+  std::vector<std::uint32_t> expected = values;
+  std::sort(expected.begin(), expected.end());
+  std::vector<std::uint32_t> scratch(values.size());
+
+  radix_detail::lsd_sort(values.data(), scratch.data(), values.size(), radix_detail::identity_key{}, 4);
+  EXPECT_EQ(values, expected);
+
+  values = random_values<std::uint32_t>(1000, 6);
+  expected = values;
+  std::sort(expected.begin(), expected.end());
+  parallel_radix_sort(
+      contiguous_view<std::uint32_t>(values.begin(), values.end()),
+      contiguous_view<std::uint32_t>(scratch.begin(), scratch.end())
+  );
+  EXPECT_EQ(values, expected);
+}
+
+TEST(radix_sort_tests, small_scratch) {
+  std::vector<int> values(4);
+  std::vector<int> scratch(3);
+
+  EXPECT_THROW(
+      radix_sort(
+          contiguous_view<int>(values.begin(), values.end()),
+          contiguous_view<int>(scratch.begin(), scratch.end())
+      ),
+      assertion_error
+  );
+}
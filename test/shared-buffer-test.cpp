@@ -0,0 +1,129 @@
+#include "shared-buffer.h"
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+TEST(shared_buffer_tests, allocate_and_share) {
+  auto buffer = shared_buffer<int>::allocate(10);
+  std::iota(buffer.begin(), buffer.end(), 0);
+
+  EXPECT_EQ(buffer.size(), 10);
+  EXPECT_EQ(buffer.use_count(), 1);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(buffer.data()) % cache_line_size, 0);
+
+  shared_buffer<int> copy = buffer;
+  EXPECT_EQ(buffer.use_count(), 2);
+  EXPECT_EQ(copy.data(), buffer.data());
+
+  shared_buffer<int> moved = std::move(copy);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(copy.use_count(), 0);
+  EXPECT_EQ(moved.use_count(), 2);
+
+  moved.reset();
+  EXPECT_EQ(buffer.use_count(), 1);
+}
+
+TEST(shared_buffer_tests, slices_keep_allocation_alive) {
+  shared_buffer<const int> tail;
+  {
+    auto buffer = shared_buffer<int>::allocate(8);
+    std::iota(buffer.begin(), buffer.end(), 0);
+    tail = buffer.slice(5);
+    auto middle = buffer.slice(2, 3);
+
+    EXPECT_EQ(middle.size(), 3);
+    EXPECT_EQ(middle[0], 2);
+    EXPECT_EQ(buffer.use_count(), 3);
+    EXPECT_EQ(middle.slice(1, 1)[0], 3);
+    EXPECT_THROW(buffer.slice(6, 3), assertion_error);
+  }
+  EXPECT_EQ(tail.use_count(), 1);
+  ASSERT_EQ(tail.size(), 3);
+  EXPECT_EQ(tail[0], 5);
+  EXPECT_EQ(tail[2], 7);
+}
+
+TEST(shared_buffer_tests, view_api) {
+  auto buffer = shared_buffer<int>::allocate(6);
+  std::iota(buffer.begin(), buffer.end(), 10);
+
+  contiguous_view<int> v = buffer;
+  EXPECT_EQ(v.size(), 6);
+  EXPECT_EQ(buffer.first(2).back(), 11);
+  EXPECT_EQ(buffer.last(2).front(), 14);
+  EXPECT_EQ(buffer.subview(1, 2)[1], 12);
+  EXPECT_EQ(buffer.subview(4).size(), 2);
+  EXPECT_THROW(buffer.first(7), assertion_error);
+
+  buffer.view()[0] = 42;
+  EXPECT_EQ(buffer[0], 42);
+}
+
+TEST(shared_buffer_tests, non_atomic_mode) {
+  auto buffer = local_shared_buffer<double>::allocate(4);
+  auto part = buffer.slice(1);
+  EXPECT_EQ(buffer.use_count(), 2);
+  part.reset();
+  EXPECT_EQ(buffer.use_count(), 1);
+}
+
+TEST(shared_buffer_tests, size_overflow) {
+  EXPECT_THROW(shared_buffer<std::uint64_t>::allocate(SIZE_MAX / 8 + 9), assertion_error);
+  EXPECT_THROW(shared_buffer<std::uint64_t>::allocate(SIZE_MAX / 8), assertion_error);
+  buffer_pool pool;
+  EXPECT_THROW(shared_buffer<char>::allocate(SIZE_MAX, pool), assertion_error);
+  EXPECT_EQ(pool.heap_allocations(), 0);
+}
+
+TEST(shared_buffer_tests, pool_recycles_blocks) {
+  buffer_pool pool;
+  for (int round = 0; round < 100; ++round) {
+    auto small = shared_buffer<std::uint32_t>::allocate(100, pool);
+    auto large = shared_buffer<std::uint32_t>::allocate(5000, pool);
+    auto slice = large.slice(10, 10);
+    small[0] = 1;
+  }
+  // One block per size class, reused on every round after the first.
+  EXPECT_EQ(pool.heap_allocations(), 2);
+  EXPECT_EQ(pool.cached_blocks(), 2);
+
+  auto a = shared_buffer<std::uint32_t>::allocate(100, pool);
+  EXPECT_EQ(pool.cached_blocks(), 1);
+  auto b = shared_buffer<std::uint32_t>::allocate(100, pool);
+  EXPECT_EQ(pool.heap_allocations(), 3);
+}
+
+TEST(shared_buffer_tests, pool_respects_cache_limit) {
+  buffer_pool pool(1);
+  {
+    auto a = shared_buffer<char>::allocate(10, pool);
+    auto b = shared_buffer<char>::allocate(10, pool);
+  }
+  EXPECT_EQ(pool.cached_blocks(), 1);
+}
+
+TEST(shared_buffer_tests, concurrent_copies) {
+  buffer_pool pool;
+  auto buffer = shared_buffer<int>::allocate(1024, pool);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([buffer, t] {
+      for (int i = 0; i < 1000; ++i) {
+        auto slice = buffer.slice(static_cast<size_t>(t) * 256, 256);
+        slice[static_cast<size_t>(i) % 256] = t;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(buffer.use_count(), 1);
+  EXPECT_EQ(buffer[256], 1);
+  buffer.reset();
+  EXPECT_EQ(pool.cached_blocks(), 1);
+}
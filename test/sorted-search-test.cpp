@@ -0,0 +1,105 @@
+#include "sorted-search.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+namespace {
+
+std::vector<std::uint64_t> sorted_keys(size_t n) {
+  std::mt19937_64 rng(n);
+  std::vector<std::uint64_t> keys(n);
+  for (auto& k : keys) {
+    k = rng() % (4 * n + 1);
+  }
+  std::sort(keys.begin(), keys.end());
+  return keys;
+}
+
+} // namespace
+
+TEST(sorted_search_tests, branchless_bounds) {
+  for (size_t n : {0, 1, 2, 3, 7, 64, 1000}) {
+    auto keys = sorted_keys(n);
+    contiguous_view<const std::uint64_t> v(keys.begin(), keys.end());
+    for (std::uint64_t key = 0; key <= 4 * n + 2; ++key) {
+      auto lower = std::lower_bound(keys.begin(), keys.end(), key) - keys.begin();
+      auto upper = std::upper_bound(keys.begin(), keys.end(), key) - keys.begin();
+      ASSERT_EQ(branchless_lower_bound(v, key), lower) << "n = " << n << ", key = " << key;
+      ASSERT_EQ(branchless_upper_bound(v, key), upper) << "n = " << n << ", key = " << key;
+    }
+  }
+}
+
+TEST(sorted_search_tests, eytzinger) {
+  for (size_t n : {0, 1, 2, 5, 15, 16, 1000}) {
+    auto keys = sorted_keys(n);
+    std::vector<std::uint64_t> layout(eytzinger_index<std::uint64_t>::required_size(n));
+    auto index = eytzinger_index<std::uint64_t>::build(
+        contiguous_view<const std::uint64_t>(keys.begin(), keys.end()),
+        contiguous_view<std::uint64_t>(layout.begin(), layout.end())
+    );
+
+    EXPECT_EQ(index.size(), n);
+    for (std::uint64_t key = 0; key <= 4 * n + 2; ++key) {
+      auto it = std::lower_bound(keys.begin(), keys.end(), key);
+      size_t pos = index.lower_bound(key);
+      if (it == keys.end()) {
+        ASSERT_EQ(pos, eytzinger_index<std::uint64_t>::npos);
+      } else {
+        ASSERT_NE(pos, eytzinger_index<std::uint64_t>::npos);
+        ASSERT_EQ(index[pos], *it);
+      }
+    }
+  }
+}
+
+TEST(sorted_search_tests, static_btree) {
+  for (size_t n : {0, 1, 7, 8, 9, 72, 73, 1000}) {
+    auto keys = sorted_keys(n);
+    std::vector<std::uint64_t> layout(static_btree<std::uint64_t>::required_size(n));
+    auto tree = static_btree<std::uint64_t>::build(
+        contiguous_view<const std::uint64_t>(keys.begin(), keys.end()),
+        contiguous_view<std::uint64_t>(layout.begin(), layout.end())
+    );
+
+    for (std::uint64_t key = 0; key <= 4 * n + 2; ++key) {
+      auto it = std::lower_bound(keys.begin(), keys.end(), key);
+      auto found = tree.lower_bound(key);
+      if (it == keys.end()) {
+        ASSERT_FALSE(found.has_value());
+      } else {
+        ASSERT_EQ(found, *it) << "n = " << n << ", key = " << key;
+      }
+    }
+  }
+}
+
+TEST(sorted_search_tests, static_btree_max_key) {
+  std::vector<std::int32_t> keys{-5, 0, 3, std::numeric_limits<std::int32_t>::max()};
+  std::vector<std::int32_t> layout(static_btree<std::int32_t>::required_size(keys.size()));
+  auto tree = static_btree<std::int32_t>::build(
+      contiguous_view<const std::int32_t>(keys.begin(), keys.end()),
+      contiguous_view<std::int32_t>(layout.begin(), layout.end())
+  );
+
+  EXPECT_EQ(tree.lower_bound(-10), -5);
+  EXPECT_EQ(tree.lower_bound(1), 3);
+  EXPECT_EQ(tree.lower_bound(4), std::numeric_limits<std::int32_t>::max());
+}
+
+TEST(sorted_search_tests, wrong_output_size) {
+  std::vector<std::uint64_t> keys{1, 2, 3};
+  std::vector<std::uint64_t> layout(3);
+
+  EXPECT_THROW(
+      eytzinger_index<std::uint64_t>::build(
+          contiguous_view<const std::uint64_t>(keys.begin(), keys.end()),
+          contiguous_view<std::uint64_t>(layout.begin(), layout.end())
+      ),
+      assertion_error
+  );
+}
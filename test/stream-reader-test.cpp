@@ -0,0 +1,150 @@
+#include "stream-reader.h"
+
+#include <gtest/gtest.h>
+
+#if __has_include(<unistd.h>)
+#include <fcntl.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+namespace {
+
+std::string to_string(contiguous_view<const std::byte> w) {
+  return std::string(reinterpret_cast<const char*>(w.data()), w.size());
+}
+
+class temp_file {
+public:
+  explicit temp_file(const std::string& content)
+      : _path(std::filesystem::temp_directory_path() / "contiguous-view-stream-reader-test") {
+    std::ofstream(_path, std::ios::binary) << content;
+  }
+
+  ~temp_file() {
+    std::filesystem::remove(_path);
+  }
+
+  std::string path() const {
+    return _path.string();
+  }
+
+private:
+  std::filesystem::path _path;
+};
+
+} // namespace
+
+TEST(stream_reader_tests, windows) {
+  temp_file file("abcdefghij");
+  stream_reader reader(file.path(), 4);
+
+  EXPECT_EQ(to_string(reader.next()), "abcd");
+  EXPECT_EQ(to_string(reader.next()), "efgh");
+  EXPECT_EQ(to_string(reader.next()), "ij");
+  EXPECT_TRUE(reader.next().empty());
+  EXPECT_TRUE(reader.next().empty());
+}
+
+TEST(stream_reader_tests, aligned_buffers) {
+  temp_file file(std::string(10000, 'x'));
+  stream_reader reader(file.path(), 4096, 3);
+
+  size_t total = 0;
+  for (auto w = reader.next(); !w.empty(); w = reader.next()) {
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(w.data()) % stream_reader::buffer_alignment, 0);
+    total += w.size();
+  }
+  EXPECT_EQ(total, 10000);
+}
+
+TEST(stream_reader_tests, carry_records) {
+  temp_file file("one\ntwo\nthree\nfour\n");
+  stream_reader reader(file.path(), 5, 2, 8);
+
+  std::string records;
+  for (auto w = reader.next(); !w.empty(); w = reader.next()) {
+    std::string text = to_string(w);
+    size_t last_newline = text.rfind('\n');
+    size_t complete = last_newline == std::string::npos ? 0 : last_newline + 1;
+    records += text.substr(0, complete) + "|";
+    reader.carry(text.size() - complete);
+  }
+  EXPECT_EQ(records, "one\n|two\n|three\n|four\n|");
+}
+
+TEST(stream_reader_tests, pipe) {
+  int fds[2];
+  ASSERT_EQ(::pipe(fds), 0);
+  std::thread writer([fd = fds[1]] {
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(::write(fd, "0123456789", 10), 10);
+    }
+    ::close(fd);
+  });
+
+  size_t total = 0;
+  {
+    stream_reader reader(fds[0], 64);
+    for (auto w = reader.next(); !w.empty(); w = reader.next()) {
+      EXPECT_TRUE(w.size() == 64 || total + w.size() == 1000);
+      total += w.size();
+    }
+  }
+  writer.join();
+  ::close(fds[0]);
+  EXPECT_EQ(total, 1000);
+}
+
+TEST(stream_reader_tests, carry_past_end) {
+  temp_file file("abc");
+  stream_reader reader(file.path(), 4, 2, 4);
+
+  EXPECT_EQ(to_string(reader.next()), "abc");
+  reader.carry(2);
+  EXPECT_EQ(to_string(reader.next()), "bc");
+  EXPECT_THROW(reader.carry(1), assertion_error);
+  EXPECT_TRUE(reader.next().empty());
+}
+
+TEST(stream_reader_tests, missing_file) {
+  EXPECT_THROW(stream_reader("/nonexistent/file", 16), std::system_error);
+}
+
+TEST(stream_reader_tests, partly_consumed_descriptor) {
+  temp_file file("HEADER\nbody-bytes");
+  int fd = ::open(file.path().c_str(), O_RDONLY);
+  char header[7];
+  ASSERT_EQ(::read(fd, header, sizeof(header)), 7);
+
+  {
+    stream_reader reader(fd, 4);
+    std::string body;
+    for (auto w = reader.next(); !w.empty(); w = reader.next()) {
+      body += to_string(w);
+    }
+    EXPECT_EQ(body, "body-bytes");
+  }
+  EXPECT_EQ(::lseek(fd, 0, SEEK_CUR), 17);
+  ::close(fd);
+}
+
+TEST(stream_reader_tests, failed_construction_closes_file) {
+  temp_file file("abc");
+  // The lowest free descriptor; a leak would keep it taken.
+  int free_fd = ::open(file.path().c_str(), O_RDONLY);
+  ::close(free_fd);
+
+  EXPECT_THROW(stream_reader(file.path(), 0), assertion_error);
+  EXPECT_THROW(stream_reader(file.path(), 16, 1), assertion_error);
+
+  int fd = ::open(file.path().c_str(), O_RDONLY);
+  EXPECT_EQ(fd, free_fd);
+  ::close(fd);
+}
+
+#endif
@@ -0,0 +1,150 @@
+#include "string-interner.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <random>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+std::string identifier(std::mt19937& rng) {
+  std::string s(1 + rng() % 24, 'a');
+  for (char& c : s) {
+    c = static_cast<char>('a' + rng() % 26);
+  }
+  return s;
+}
+
+} // namespace
+
+TEST(string_interner_tests, intern_and_find) {
+  string_interner interner;
+  EXPECT_FALSE(interner.find("missing").has_value());
+
+  auto foo = interner.intern("foo");
+  auto bar = interner.intern("bar");
+  auto again = interner.intern(std::string("foo"));
+
+  EXPECT_EQ(foo.id, 0);
+  EXPECT_EQ(bar.id, 1);
+  EXPECT_EQ(again.id, foo.id);
+  EXPECT_EQ(again.text.data(), foo.text.data());
+  EXPECT_EQ(std::string_view(foo.text), "foo");
+  EXPECT_EQ(interner.size(), 2);
+
+  EXPECT_EQ(std::string_view(interner.text(bar.id)), "bar");
+  EXPECT_THROW(interner.text(2), assertion_error);
+  EXPECT_FALSE(interner.find("fo").has_value());
+
+  auto empty = interner.intern("");
+  EXPECT_EQ(interner.intern(std::string_view()).id, empty.id);
+  EXPECT_TRUE(empty.text.empty());
+}
+
+TEST(string_interner_tests, heterogeneous_lookup) {
+  string_interner interner;
+  auto id = interner.intern("needle").id;
+
+  std::string haystack = "find the needle here";
+  char_view view(haystack.data(), haystack.size());
+  auto hit = interner.find(view.subview(9, 6));
+  ASSERT_TRUE(hit.has_value());
+  EXPECT_EQ(hit->id, id);
+
+  std::array<char, 6> fixed{'n', 'e', 'e', 'd', 'l', 'e'};
+  EXPECT_EQ(interner.intern(contiguous_view<const char, 6>(fixed.data(), 6)).id, id);
+  EXPECT_EQ(interner.size(), 1);
+}
+
+TEST(string_interner_tests, views_stay_valid_across_growth) {
+  std::mt19937 rng(5);
+  string_interner interner;
+  std::unordered_map<std::string, std::uint32_t> reference;
+  std::vector<interned_string> results;
+
+  for (int i = 0; i < 100000; ++i) {
+    std::string key = identifier(rng);
+    auto result = interner.intern(key);
+    auto [it, inserted] = reference.emplace(key, result.id);
+    EXPECT_EQ(it->second, result.id);
+    if (inserted) {
+      results.push_back(result);
+    }
+  }
+
+  ASSERT_EQ(interner.size(), reference.size());
+  for (const auto& r : results) {
+    EXPECT_EQ(interner.text(r.id).data(), r.text.data());
+    EXPECT_EQ(interner.find(r.text)->id, r.id);
+  }
+  for (const auto& [key, id] : reference) {
+    EXPECT_EQ(std::string_view(interner.text(id)), key);
+  }
+}
+
+TEST(string_interner_tests, memory_close_to_key_length) {
+  string_interner interner(10000);
+  size_t key_bytes = 0;
+  for (int i = 0; i < 10000; ++i) {
+    std::string key = "identifier_" + std::to_string(i);
+    key_bytes += key.size();
+    interner.intern(key);
+  }
+  EXPECT_GE(interner.arena_bytes(), key_bytes);
+  EXPECT_LT(interner.arena_bytes(), key_bytes + 64 * 1024);
+  // Per key: a length byte, a 4-byte record and 5 bytes per table slot at a
+  // load of about 0.6.
+  EXPECT_LT(interner.memory_usage(), key_bytes + 10000 * 14 + 64 * 1024);
+
+  std::string large(100000, 'x');
+  auto big = interner.intern(large);
+  EXPECT_EQ(big.text.size(), large.size());
+  EXPECT_EQ(std::string_view(interner.text(big.id)), large);
+  // Lengths of 128 and more take a multi-byte prefix.
+  std::string medium(300, 'm');
+  EXPECT_EQ(std::string_view(interner.text(interner.intern(medium).id)), medium);
+  EXPECT_EQ(interner.intern("identifier_42").id, 42);
+}
+
+TEST(string_interner_tests, concurrent_interning) {
+  concurrent_string_interner interner(8);
+  EXPECT_EQ(interner.shards(), 8);
+
+  std::vector<std::string> keys;
+  std::mt19937 rng(9);
+  for (int i = 0; i < 2000; ++i) {
+    keys.push_back(identifier(rng) + std::to_string(i));
+  }
+
+  std::vector<std::vector<std::uint32_t>> ids(4, std::vector<std::uint32_t>(keys.size()));
+  std::vector<std::thread> threads;
+  for (size_t t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      for (size_t i = 0; i < keys.size(); ++i) {
+        // Each thread walks the keys in a different order; the strides are
+        // coprime with the key count.
+        constexpr size_t strides[] = {1, 3, 7, 9};
+        size_t k = (i * strides[t]) % keys.size();
+        ids[t][k] = interner.intern(keys[k]).id;
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  EXPECT_EQ(interner.size(), keys.size());
+  for (size_t k = 0; k < keys.size(); ++k) {
+    for (size_t t = 1; t < 4; ++t) {
+      EXPECT_EQ(ids[t][k], ids[0][k]);
+    }
+    EXPECT_EQ(std::string_view(interner.text(ids[0][k])), keys[k]);
+    EXPECT_EQ(interner.find(keys[k])->id, ids[0][k]);
+  }
+  EXPECT_FALSE(interner.find("not interned").has_value());
+}
@@ -0,0 +1,106 @@
+#include "text-search.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace {
+
+char_view view(const std::string& s) {
+  return char_view(s.data(), s.size());
+}
+
+std::string random_text(std::mt19937& rng, size_t n, char alphabet) {
+  std::string s(n, 'a');
+  for (char& c : s) {
+    c = static_cast<char>('a' + rng() % static_cast<unsigned>(alphabet));
+  }
+  return s;
+}
+
+} // namespace
+
+TEST(text_search_tests, find_basic) {
+  std::string text = "the quick brown fox jumps over the lazy dog";
+
+  EXPECT_EQ(find_substring(view(text), view("fox")), 16);
+  EXPECT_EQ(find_substring(view(text), view("the")), 0);
+  EXPECT_EQ(find_substring(view(text), view("dog")), text.size() - 3);
+  EXPECT_EQ(find_substring(view(text), view("cat")), dynamic_extent);
+  EXPECT_EQ(find_substring(view(text), view("")), 0);
+  EXPECT_EQ(find_substring(view("ab"), view("abc")), dynamic_extent);
+  EXPECT_TRUE(contains_substring(view(text), view("lazy")));
+  EXPECT_EQ(count_substring(view(text), view("the")), 2);
+  EXPECT_EQ(count_substring(view("aaaa"), view("aa")), 2);
+}
+
+TEST(text_search_tests, find_matches_string_view) {
+  std::mt19937 rng(7);
+  for (int iteration = 0; iteration < 2000; ++iteration) {
+    char alphabet = static_cast<char>(2 + iteration % 3);
+    std::string text = random_text(rng, rng() % 400, alphabet);
+    size_t m = 1 + rng() % (iteration % 2 == 0 ? 8 : 120);
+    std::string needle = random_text(rng, m, alphabet);
+    if (iteration % 5 == 0 && text.size() > m) {
+      text.replace(rng() % (text.size() - m), m, needle);
+    }
+
+    ASSERT_EQ(find_substring(view(text), view(needle)), std::string_view(text).find(needle))
+        << "text = " << text << ", needle = " << needle;
+  }
+}
+
+TEST(text_search_tests, two_way_periodic_needle) {
+  std::string needle = std::string(100, 'a') + "b";
+  std::string text = std::string(1000, 'a') + needle + std::string(10, 'a');
+
+  EXPECT_EQ(find_substring(view(text), view(needle)), 1000);
+  EXPECT_EQ(find_substring(view(std::string(5000, 'a')), view(needle)), dynamic_extent);
+}
+
+TEST(text_search_tests, multi_pattern) {
+  multi_pattern_matcher matcher({"he", "she", "his", "hers"});
+  std::string text = "ushers and his";
+
+  auto matches = matcher.find_all(view(text));
+
+  ASSERT_EQ(matches.size(), 4);
+  EXPECT_EQ(matches[0].pattern, 1);
+  EXPECT_EQ(matches[0].text.data(), text.data() + 1);
+  EXPECT_EQ(matches[1].pattern, 0);
+  EXPECT_EQ(matches[1].text.data(), text.data() + 2);
+  EXPECT_EQ(matches[2].pattern, 3);
+  EXPECT_EQ(std::string_view(matches[2].text), "hers");
+  EXPECT_EQ(matches[3].pattern, 2);
+  EXPECT_EQ(matches[3].text.data(), text.data() + 11);
+
+  EXPECT_TRUE(matcher.contains_any(view(text)));
+  EXPECT_FALSE(matcher.contains_any(view("nothing to see")));
+}
+
+TEST(text_search_tests, multi_pattern_reused) {
+  std::vector<std::string> patterns{"ERROR", "WARN", "ERR"};
+  multi_pattern_matcher matcher(patterns);
+  std::mt19937 rng(11);
+
+  for (int iteration = 0; iteration < 100; ++iteration) {
+    std::string text = random_text(rng, 200, 3);
+    text.insert(rng() % text.size(), patterns[rng() % patterns.size()]);
+
+    size_t expected = 0;
+    for (const auto& p : patterns) {
+      for (size_t pos = text.find(p); pos != std::string::npos; pos = text.find(p, pos + 1)) {
+        ++expected;
+      }
+    }
+    size_t found = 0;
+    matcher.for_each_match(view(text), [&](const text_match& m) {
+      EXPECT_EQ(std::string_view(m.text), patterns[m.pattern]);
+      ++found;
+    });
+    EXPECT_EQ(found, expected);
+  }
+}
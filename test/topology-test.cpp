@@ -0,0 +1,175 @@
+#include "topology.h"
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+
+namespace {
+
+class fake_sysfs {
+public:
+  fake_sysfs()
+      : _root(std::filesystem::temp_directory_path() / "contiguous-view-topology-test") {
+    std::filesystem::remove_all(_root);
+  }
+
+  ~fake_sysfs() {
+    std::filesystem::remove_all(_root);
+  }
+
+  void write(const std::string& path, const std::string& content) {
+    std::filesystem::path file = _root / path;
+    std::filesystem::create_directories(file.parent_path());
+    std::ofstream(file) << content << "\n";
+  }
+
+  std::string root() const {
+    return _root.string();
+  }
+
+private:
+  std::filesystem::path _root;
+};
+
+} // namespace
+
+TEST(topology_tests, parse_cache_size) {
+  EXPECT_EQ(parse_cache_size("48K"), 48 * 1024);
+  EXPECT_EQ(parse_cache_size("8M"), 8 * 1024 * 1024);
+  EXPECT_EQ(parse_cache_size("512"), 512);
+}
+
+TEST(topology_tests, parse_cpu_list) {
+  EXPECT_EQ(parse_cpu_list("0-3,8,10-11"), (std::vector<unsigned>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(parse_cpu_list("0"), (std::vector<unsigned>{0}));
+  EXPECT_TRUE(parse_cpu_list("").empty());
+}
+
+TEST(topology_tests, read_fake_sysfs) {
+  fake_sysfs fs;
+  fs.write("online", "0-3");
+  unsigned core_ids[] = {0, 1, 0, 1};
+  unsigned package_ids[] = {0, 0, 0, 1};
+  for (unsigned cpu = 0; cpu < 4; ++cpu) {
+    fs.write("cpu" + std::to_string(cpu) + "/topology/core_id", std::to_string(core_ids[cpu]));
+    fs.write("cpu" + std::to_string(cpu) + "/topology/physical_package_id", std::to_string(package_ids[cpu]));
+  }
+  const char* levels[] = {"1", "1", "2", "3"};
+  const char* types[] = {"Data", "Instruction", "Unified", "Unified"};
+  const char* sizes[] = {"48K", "32K", "2048K", "30M"};
+  for (int i = 0; i < 4; ++i) {
+    std::string dir = "cpu0/cache/index" + std::to_string(i);
+    fs.write(dir + "/level", levels[i]);
+    fs.write(dir + "/type", types[i]);
+    fs.write(dir + "/size", sizes[i]);
+  }
+
+  cpu_topology t = read_cpu_topology(fs.root());
+
+  EXPECT_EQ(t.cpus.size(), 4);
+  EXPECT_EQ(t.packages(), 2);
+  EXPECT_EQ(t.l2_bytes, 2048 * 1024);
+  EXPECT_EQ(t.llc_bytes, 30 * 1024 * 1024);
+  // cpu2 is the SMT sibling of cpu0
+  EXPECT_EQ(t.physical_cores(), (std::vector<unsigned>{0, 1, 3}));
+}
+
+TEST(topology_tests, missing_sysfs_falls_back) {
+  cpu_topology t = read_cpu_topology("/nonexistent");
+
+  EXPECT_FALSE(t.cpus.empty());
+  EXPECT_EQ(t.packages(), 1);
+  EXPECT_GT(t.l2_bytes, 0);
+}
+
+TEST(topology_tests, restrict_to_allowed_cpus) {
+  cpu_topology t{{{0, 0, 0}, {1, 1, 0}, {2, 0, 0}, {3, 1, 0}}, 1024, 4096};
+
+  t.restrict_to({1, 2, 7});
+  ASSERT_EQ(t.cpus.size(), 2);
+  EXPECT_EQ(t.cpus[0].id, 1);
+  EXPECT_EQ(t.cpus[1].id, 2);
+  t.restrict_to({5});
+  EXPECT_EQ(t.cpus.size(), 2);
+  t.restrict_to({});
+  EXPECT_EQ(t.cpus.size(), 2);
+
+  cpu_topology current = current_cpu_topology();
+  EXPECT_FALSE(current.cpus.empty());
+  std::vector<unsigned> allowed = allowed_cpus();
+  if (!allowed.empty()) {
+    for (const cpu_info& cpu : current.cpus) {
+      EXPECT_NE(std::find(allowed.begin(), allowed.end(), cpu.id), allowed.end());
+    }
+  }
+}
+
+TEST(topology_tests, plan) {
+  view_partitioner p(cpu_topology{{{0, 0, 0}, {1, 1, 0}, {2, 0, 0}, {3, 1, 0}}, 1024, 4096});
+
+  tiling_plan plan = p.plan(1000, sizeof(int));
+
+  EXPECT_EQ(plan.tile_elements, 128);
+  EXPECT_EQ(plan.tiles, 8);
+  EXPECT_EQ(plan.workers, 2);
+  EXPECT_EQ(plan.tile_begin(0), 0);
+  EXPECT_EQ(plan.tile_begin(1), 4);
+  EXPECT_EQ(plan.tile_begin(2), 8);
+  EXPECT_FALSE(plan.describe().empty());
+}
+
+TEST(topology_tests, run_covers_view) {
+  view_partitioner p(cpu_topology{{{0, 0, 0}, {1, 1, 0}}, 256, 1024});
+  std::vector<int> data(1000, 1);
+  contiguous_view<int> v(data.begin(), data.end());
+
+  p.first_touch(v);
+  for (int x : data) {
+    EXPECT_EQ(x, 0);
+  }
+
+  std::atomic<size_t> covered = 0;
+  tiling_plan plan = p.run(
+      v,
+      [&covered](size_t, contiguous_view<int> tile) {
+        for (int& x : tile) {
+          ++x;
+        }
+        covered += tile.size();
+      },
+      false
+  );
+
+  EXPECT_EQ(covered, data.size());
+  EXPECT_EQ(plan.tiles, (1000 + 31) / 32);
+  for (int x : data) {
+    EXPECT_EQ(x, 1);
+  }
+}
+
+TEST(topology_tests, run_rethrows_worker_errors) {
+  view_partitioner p(cpu_topology{{{0, 0, 0}, {1, 1, 0}}, 256, 1024});
+  std::vector<int> data(1000, 0);
+  contiguous_view<int> v(data.begin(), data.end());
+
+  std::atomic<size_t> tiles = 0;
+  EXPECT_THROW(
+      p.run(
+          v,
+          [&tiles](size_t worker, contiguous_view<int> tile) {
+            ++tiles;
+            if (worker == 1) {
+              static_cast<void>(tile[tile.size()]);
+            }
+          },
+          false
+      ),
+      assertion_error
+  );
+  // Worker 0 finished all of its tiles; worker 1 stopped at its first.
+  EXPECT_EQ(tiles, p.plan(data.size(), sizeof(int)).tile_begin(1) + 1);
+}
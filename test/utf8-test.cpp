@@ -0,0 +1,219 @@
+#include "utf8.h"
+
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+char_view view(const std::string& s) {
+  return char_view(s.data(), s.size());
+}
+
+// Straight transcription of the well-formed byte sequences table of the
+// Unicode standard (table 3-7).
+bool reference_valid(const std::string& s) {
+  auto at = [&s](size_t i) {
+    return static_cast<unsigned char>(s[i]);
+  };
+  auto in = [](unsigned char b, unsigned lo, unsigned hi) {
+    return b >= lo && b <= hi;
+  };
+  for (size_t i = 0; i < s.size();) {
+    unsigned char b = at(i);
+    size_t rest = s.size() - i;
+    if (b <= 0x7F) {
+      i += 1;
+    } else if (in(b, 0xC2, 0xDF) && rest >= 2 && in(at(i + 1), 0x80, 0xBF)) {
+      i += 2;
+    } else if (rest >= 3 && in(at(i + 2), 0x80, 0xBF) &&
+               ((b == 0xE0 && in(at(i + 1), 0xA0, 0xBF)) || (in(b, 0xE1, 0xEC) && in(at(i + 1), 0x80, 0xBF)) ||
+                (b == 0xED && in(at(i + 1), 0x80, 0x9F)) || (in(b, 0xEE, 0xEF) && in(at(i + 1), 0x80, 0xBF)))) {
+      i += 3;
+    } else if (rest >= 4 && in(at(i + 2), 0x80, 0xBF) && in(at(i + 3), 0x80, 0xBF) &&
+               ((b == 0xF0 && in(at(i + 1), 0x90, 0xBF)) || (in(b, 0xF1, 0xF3) && in(at(i + 1), 0x80, 0xBF)) ||
+                (b == 0xF4 && in(at(i + 1), 0x80, 0x8F)))) {
+      i += 4;
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+char32_t random_code_point(std::mt19937& rng) {
+  switch (rng() % 4) {
+  case 0:
+    return static_cast<char32_t>(rng() % 0x80);
+  case 1:
+    return static_cast<char32_t>(0x80 + rng() % (0x800 - 0x80));
+  case 2: {
+    char32_t cp = static_cast<char32_t>(0x800 + rng() % (0x10000 - 0x800));
+    return (cp & 0xF800) == 0xD800 ? U'x' : cp;
+  }
+  default:
+    return static_cast<char32_t>(0x10000 + rng() % (0x110000 - 0x10000));
+  }
+}
+
+std::u32string random_text(std::mt19937& rng, size_t n) {
+  std::u32string text(n, U'a');
+  for (auto& c : text) {
+    // Mostly ASCII with multi-byte runs, as in real text.
+    c = rng() % 3 == 0 ? random_code_point(rng) : static_cast<char32_t>('a' + rng() % 26);
+  }
+  return text;
+}
+
+std::string to_utf8(const std::u32string& text) {
+  contiguous_view<const char32_t> in(text.data(), text.size());
+  std::string out(utf8_length_from_utf32(in), '\0');
+  size_t written = utf32_to_utf8(in, contiguous_view<char>(out.data(), out.size()));
+  EXPECT_EQ(written, out.size());
+  return out;
+}
+
+} // namespace
+
+TEST(utf8_tests, validate_known_sequences) {
+  EXPECT_TRUE(validate_utf8(view("")));
+  EXPECT_TRUE(validate_utf8(view("plain ascii")));
+  EXPECT_TRUE(validate_utf8(view("h\xC3\xA9llo \xE2\x82\xAC \xF0\x9F\x98\x80")));
+  EXPECT_TRUE(validate_utf8(view("\xEF\xBF\xBF\xF4\x8F\xBF\xBF")));
+
+  EXPECT_FALSE(validate_utf8(view("\x80")));
+  EXPECT_FALSE(validate_utf8(view("\xC0\xAF")));
+  EXPECT_FALSE(validate_utf8(view("\xC1\xBF")));
+  EXPECT_FALSE(validate_utf8(view("\xE0\x80\xAF")));
+  EXPECT_FALSE(validate_utf8(view("\xF0\x80\x80\xAF")));
+  EXPECT_FALSE(validate_utf8(view("\xED\xA0\x80")));
+  EXPECT_FALSE(validate_utf8(view("\xF4\x90\x80\x80")));
+  EXPECT_FALSE(validate_utf8(view("\xF5\x80\x80\x80")));
+  EXPECT_FALSE(validate_utf8(view("\xFF")));
+  EXPECT_FALSE(validate_utf8(view("\xE2\x82")));
+  EXPECT_FALSE(validate_utf8(view("\xC3\xA9\xA9")));
+  EXPECT_FALSE(validate_utf8(view("\xE2\x82 ")));
+}
+
+TEST(utf8_tests, validate_across_block_boundaries) {
+  // Put a three-byte sequence at every offset around the 16- and 64-byte
+  // block edges, whole and cut short.
+  for (size_t pad = 0; pad < 80; ++pad) {
+    std::string whole = std::string(pad, 'a') + "\xE2\x82\xAC" + std::string(70, 'b');
+    EXPECT_TRUE(validate_utf8(view(whole))) << pad;
+
+    std::string cut = std::string(pad, 'a') + "\xE2\x82";
+    EXPECT_FALSE(validate_utf8(view(cut))) << pad;
+    EXPECT_FALSE(validate_utf8(view(cut + std::string(70, 'b')))) << pad;
+
+    std::string stray = std::string(pad, 'a') + "\x80" + std::string(70, 'b');
+    EXPECT_FALSE(validate_utf8(view(stray))) << pad;
+  }
+}
+
+TEST(utf8_tests, validate_matches_reference_on_mutations) {
+  std::mt19937 rng(7);
+  for (int round = 0; round < 2000; ++round) {
+    std::string s = to_utf8(random_text(rng, rng() % 100));
+    ASSERT_TRUE(validate_utf8(view(s)));
+    if (s.empty()) {
+      continue;
+    }
+    for (int m = 0; m < 3; ++m) {
+      s[rng() % s.size()] = static_cast<char>(rng());
+    }
+    ASSERT_EQ(validate_utf8(view(s)), reference_valid(s)) << round;
+  }
+}
+
+TEST(utf8_tests, round_trip_utf16_and_utf32) {
+  std::mt19937 rng(11);
+  for (size_t n : {0u, 1u, 15u, 16u, 17u, 100u, 1000u}) {
+    std::u32string original = random_text(rng, n);
+    std::string utf8 = to_utf8(original);
+
+    EXPECT_EQ(utf32_length_from_utf8(view(utf8)), original.size());
+    std::u32string utf32(utf32_length_from_utf8(view(utf8)), U'\0');
+    EXPECT_EQ(utf8_to_utf32(view(utf8), contiguous_view<char32_t>(utf32.data(), utf32.size())), utf32.size());
+    EXPECT_EQ(utf32, original);
+
+    std::u16string utf16(utf16_length_from_utf8(view(utf8)), u'\0');
+    EXPECT_EQ(utf8_to_utf16(view(utf8), contiguous_view<char16_t>(utf16.data(), utf16.size())), utf16.size());
+
+    contiguous_view<const char16_t> utf16_view(utf16.data(), utf16.size());
+    EXPECT_EQ(utf8_length_from_utf16(utf16_view), utf8.size());
+    std::string back(utf8.size(), '\0');
+    EXPECT_EQ(utf16_to_utf8(utf16_view, contiguous_view<char>(back.data(), back.size())), back.size());
+    EXPECT_EQ(back, utf8);
+  }
+}
+
+TEST(utf8_tests, transcode_known_values) {
+  std::string text = "a\xC3\xA9\xE2\x82\xAC\xF0\x9F\x98\x80";
+  std::u16string utf16(5, u'\0');
+  EXPECT_EQ(utf8_to_utf16(view(text), contiguous_view<char16_t>(utf16.data(), utf16.size())), 5);
+  EXPECT_EQ(utf16, u"aé€\U0001F600");
+
+  std::u32string utf32(4, U'\0');
+  EXPECT_EQ(utf8_to_utf32(view(text), contiguous_view<char32_t>(utf32.data(), utf32.size())), 4);
+  EXPECT_EQ(utf32, U"aé€\U0001F600");
+}
+
+TEST(utf8_tests, transcode_rejects_bad_input_and_short_output) {
+  std::string text = "caf\xC3\xA9";
+  std::u16string small(3, u'\0');
+  EXPECT_THROW(utf8_to_utf16(view(text), contiguous_view<char16_t>(small.data(), small.size())), assertion_error);
+
+  std::string invalid = "caf\xC3";
+  std::u32string out(8, U'\0');
+  EXPECT_THROW(utf8_to_utf32(view(invalid), contiguous_view<char32_t>(out.data(), out.size())), assertion_error);
+
+  std::u16string lone = u"a\xD800" u"b";
+  std::string bytes(8, '\0');
+  EXPECT_THROW(
+      utf16_to_utf8(contiguous_view<const char16_t>(lone.data(), lone.size()), contiguous_view<char>(bytes.data(), 8)),
+      assertion_error
+  );
+
+  std::u32string surrogate = U"a";
+  surrogate += static_cast<char32_t>(0xDFFF);
+  EXPECT_THROW(
+      utf32_to_utf8(
+          contiguous_view<const char32_t>(surrogate.data(), surrogate.size()), contiguous_view<char>(bytes.data(), 8)
+      ),
+      assertion_error
+  );
+}
+
+TEST(utf8_tests, transcode_exact_and_one_short_output) {
+  std::mt19937 rng(17);
+  for (size_t n : {1u, 20u, 100u}) {
+    std::u32string original = random_text(rng, n);
+    original.back() = U'\U0001F600';
+    std::string utf8 = to_utf8(original);
+    std::u16string utf16(utf16_length_from_utf8(view(utf8)), u'\0');
+    ASSERT_EQ(utf8_to_utf16(view(utf8), contiguous_view<char16_t>(utf16.data(), utf16.size())), utf16.size());
+    contiguous_view<const char16_t> in16(utf16.data(), utf16.size());
+    contiguous_view<const char32_t> in32(original.data(), original.size());
+
+    // One unit short: the last code point must not fit, and nothing is
+    // written past the view.
+    std::u16string out16(utf16.size() + 2, u'#');
+    EXPECT_THROW(utf8_to_utf16(view(utf8), contiguous_view<char16_t>(out16.data(), utf16.size() - 1)), assertion_error);
+    EXPECT_EQ(out16.substr(utf16.size() - 1), u"###");
+
+    std::u32string out32(original.size(), U'#');
+    EXPECT_THROW(
+        utf8_to_utf32(view(utf8), contiguous_view<char32_t>(out32.data(), original.size() - 1)), assertion_error
+    );
+    EXPECT_EQ(out32.back(), U'#');
+
+    std::string out8(utf8.size(), '#');
+    EXPECT_THROW(utf16_to_utf8(in16, contiguous_view<char>(out8.data(), utf8.size() - 1)), assertion_error);
+    EXPECT_EQ(out8.back(), '#');
+    EXPECT_THROW(utf32_to_utf8(in32, contiguous_view<char>(out8.data(), utf8.size() - 1)), assertion_error);
+    EXPECT_EQ(out8.back(), '#');
+  }
+}
@@ -0,0 +1,124 @@
+#include "view-copy.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <numeric>
+#include <string>
+#include <vector>
+
+namespace {
+
+class threshold_guard {
+public:
+  explicit threshold_guard(size_t bytes)
+      : _saved(non_temporal_threshold()) {
+    set_non_temporal_threshold(bytes);
+  }
+
+  ~threshold_guard() {
+    set_non_temporal_threshold(_saved);
+  }
+
+private:
+  size_t _saved;
+};
+
+} // namespace
+
+TEST(view_copy_tests, copy_into) {
+  std::array<int, 3> src{1, 2, 3};
+  std::array<int, 5> dst{};
+
+  auto written = copy_into(contiguous_view<const int, 3>(src.begin(), 3), contiguous_view<int, 5>(dst.begin(), 5));
+
+  EXPECT_EQ(written.data(), dst.data());
+  EXPECT_EQ(written.size(), 3);
+  EXPECT_EQ(dst, (std::array<int, 5>{1, 2, 3, 0, 0}));
+}
+
+TEST(view_copy_tests, copy_into_non_trivial) {
+  std::vector<std::string> src{"a", "bb"};
+  std::vector<std::string> dst(2);
+
+  copy_into(
+      contiguous_view<const std::string>(src.begin(), src.end()),
+      contiguous_view<std::string>(dst.begin(), dst.end())
+  );
+
+  EXPECT_EQ(dst, src);
+}
+
+TEST(view_copy_tests, copy_into_too_small) {
+  std::vector<int> src(4);
+  std::vector<int> dst(3);
+
+  EXPECT_THROW(
+      copy_into(contiguous_view<const int>(src.begin(), src.end()), contiguous_view<int>(dst.begin(), dst.end())),
+      assertion_error
+  );
+}
+
+TEST(view_copy_tests, copy_into_overlap) {
+  std::vector<int> data(10);
+  contiguous_view<int> v(data.begin(), data.end());
+
+  EXPECT_THROW(copy_into(v.subview(0, 5), v.subview(2)), assertion_error);
+
+  // The source lies in the part of the destination that is not written.
+  std::iota(data.begin(), data.end(), 0);
+  copy_into(contiguous_view<const int>(v.subview(7)), v);
+  EXPECT_EQ(data, (std::vector<int>{7, 8, 9, 3, 4, 5, 6, 7, 8, 9}));
+}
+
+TEST(view_copy_tests, move_into_overlap) {
+  std::vector<int> data{0, 1, 2, 3, 4, 5};
+  contiguous_view<int> v(data.begin(), data.end());
+
+  move_into(v.subview(0, 4), v.subview(2));
+  EXPECT_EQ(data, (std::vector<int>{0, 1, 0, 1, 2, 3}));
+
+  move_into(v.subview(2), v.subview(0, 4));
+  EXPECT_EQ(data, (std::vector<int>{0, 1, 2, 3, 2, 3}));
+}
+
+TEST(view_copy_tests, move_into_non_trivial) {
+  std::vector<std::string> data{"a", "b", "c", ""};
+  contiguous_view<std::string> v(data.begin(), data.end());
+
+  move_into(v.subview(0, 3), v.subview(1));
+
+  EXPECT_EQ(data[1], "a");
+  EXPECT_EQ(data[2], "b");
+  EXPECT_EQ(data[3], "c");
+}
+
+TEST(view_copy_tests, fill) {
+  std::vector<int> zeros(7, 5);
+  std::vector<int> pattern(7);
+
+  fill(contiguous_view<int>(zeros.begin(), zeros.end()), 0);
+  fill(contiguous_view<int>(pattern.begin(), pattern.end()), 0x01020304);
+
+  EXPECT_EQ(zeros, std::vector<int>(7, 0));
+  EXPECT_EQ(pattern, std::vector<int>(7, 0x01020304));
+}
+
+TEST(view_copy_tests, non_temporal_paths) {
+  threshold_guard guard(0);
+  std::vector<unsigned char> src(1000);
+  std::iota(src.begin(), src.end(), 0);
+  std::vector<unsigned char> dst(1003);
+
+  // Unaligned destination exercises the head and tail handling.
+  copy_into(
+      contiguous_view<const unsigned char>(src.begin(), src.end()),
+      contiguous_view<unsigned char>(dst.data() + 3, 1000)
+  );
+  EXPECT_TRUE(std::equal(src.begin(), src.end(), dst.begin() + 3));
+
+  fill(contiguous_view<unsigned char>(dst.data() + 1, 1001), 0xAB);
+  EXPECT_EQ(dst[0], 0);
+  EXPECT_TRUE(std::all_of(dst.begin() + 1, dst.begin() + 1002, [](unsigned char c) { return c == 0xAB; }));
+  EXPECT_EQ(dst[1002], src.back());
+}
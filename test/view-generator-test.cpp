@@ -0,0 +1,212 @@
+#include "view-generator.h"
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+// See view-generator.h.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic ignored "-Wzero-as-null-pointer-constant"
+#endif
+
+namespace {
+
+generator<int> iota(int n) {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+}
+
+generator<int> fails_after(int n) {
+  for (int i = 0; i < n; ++i) {
+    co_yield i;
+  }
+  throw std::runtime_error("upstream failed");
+}
+
+// Producer: chunks of consecutive integers from pooled buffers.
+generator<shared_buffer<const int>> numbers(buffer_pool& pool, int total, size_t chunk, std::atomic<int>& produced) {
+  int next = 0;
+  return pooled_chunks<int>(pool, chunk, [next, total, &produced](contiguous_view<int> out) mutable {
+    size_t n = 0;
+    for (; n < out.size() && next < total; ++n) {
+      out[n] = next++;
+    }
+    produced += n > 0;
+    return n;
+  });
+}
+
+// Transform stage: forwards views of its input with zero copies, dropping the
+// first element of every chunk.
+generator<contiguous_view<const int>> drop_first(generator<contiguous_view<const int>> in) {
+  for (contiguous_view<const int> chunk : in) {
+    co_yield chunk.subview(1);
+  }
+}
+
+// Asynchronous transform stage: keeps the chunk handles, slicing off the
+// first element without copying.
+generator<shared_buffer<const int>> drop_first_handles(generator<shared_buffer<const int>> in) {
+  for (const shared_buffer<const int>& chunk : in) {
+    co_yield chunk.slice(1);
+  }
+}
+
+} // namespace
+
+TEST(view_generator_tests, generator_basics) {
+  std::vector<int> values;
+  for (int v : iota(5)) {
+    values.push_back(v);
+  }
+  EXPECT_EQ(values, (std::vector<int>{0, 1, 2, 3, 4}));
+
+  int seen = 0;
+  auto g = fails_after(2);
+  EXPECT_THROW(
+      {
+        for (int v : g) {
+          seen += v + 1;
+        }
+      },
+      std::runtime_error
+  );
+  EXPECT_EQ(seen, 3);
+
+  auto empty = iota(0);
+  EXPECT_TRUE(empty.begin() == empty.end());
+}
+
+TEST(view_generator_tests, yielded_view_lives_until_resume) {
+  auto owner = []() -> generator<contiguous_view<const int>> {
+    for (int round = 0; round < 3; ++round) {
+      std::vector<int> local(4, round);
+      co_yield contiguous_view<const int>(local.data(), local.size());
+    }
+  };
+  int total = 0;
+  for (auto v : owner()) {
+    total += std::accumulate(v.begin(), v.end(), 0);
+  }
+  EXPECT_EQ(total, 4 * (0 + 1 + 2));
+}
+
+TEST(view_generator_tests, pipeline_on_thread_pool) {
+  buffer_pool pool;
+  thread_pool_executor exec(2);
+  std::atomic<int> produced = 0;
+  constexpr size_t depth = 2;
+
+  long long sum = 0;
+  int consumed = 0;
+  int max_ahead = 0;
+  for (auto chunk : drop_first(async_stage(numbers(pool, 10000, 100, produced), exec, depth))) {
+    ++consumed;
+    max_ahead = std::max(max_ahead, produced.load() - consumed);
+    sum += std::accumulate(chunk.begin(), chunk.end(), 0LL);
+    EXPECT_EQ(chunk.size(), 99);
+  }
+
+  long long expected = 0;
+  for (int i = 0; i < 10000; ++i) {
+    expected += i % 100 == 0 ? 0 : i;
+  }
+  EXPECT_EQ(sum, expected);
+  EXPECT_EQ(consumed, 100);
+  // Queued chunks plus the one being produced.
+  EXPECT_LE(max_ahead, static_cast<int>(depth) + 1);
+  // Chunks in flight at once: the queue, the producer's and the consumer's.
+  EXPECT_LE(pool.heap_allocations(), depth + 2);
+}
+
+TEST(view_generator_tests, chained_async_stages) {
+  buffer_pool pool;
+  thread_pool_executor exec(2);
+  std::atomic<int> produced = 0;
+
+  // producer -> async -> transform -> async -> consumer
+  auto chain = async_stage(drop_first_handles(async_buffer_stage(numbers(pool, 1000, 10, produced), exec)), exec);
+  long long sum = 0;
+  int consumed = 0;
+  for (auto chunk : chain) {
+    ++consumed;
+    EXPECT_EQ(chunk.size(), 9);
+    sum += std::accumulate(chunk.begin(), chunk.end(), 0LL);
+  }
+
+  long long expected = 0;
+  for (int i = 0; i < 1000; ++i) {
+    expected += i % 10 == 0 ? 0 : i;
+  }
+  EXPECT_EQ(sum, expected);
+  EXPECT_EQ(consumed, 100);
+  // Two queues of two, plus one chunk held by each stage and the producer.
+  EXPECT_LE(pool.heap_allocations(), 2 * 2 + 4);
+
+  single_thread_executor single;
+  std::vector<int> out;
+  for (auto chunk : async_stage(async_buffer_stage(numbers(pool, 30, 4, produced), single), single)) {
+    out.insert(out.end(), chunk.begin(), chunk.end());
+  }
+  std::vector<int> all(30);
+  std::iota(all.begin(), all.end(), 0);
+  EXPECT_EQ(out, all);
+}
+
+TEST(view_generator_tests, pipeline_on_single_thread) {
+  buffer_pool pool;
+  single_thread_executor exec;
+  std::atomic<int> produced = 0;
+
+  std::vector<int> out;
+  for (auto chunk : async_stage(numbers(pool, 50, 8, produced), exec, 3)) {
+    out.insert(out.end(), chunk.begin(), chunk.end());
+    EXPECT_LE(produced.load() - static_cast<int>(out.size() + 7) / 8, 4);
+  }
+  std::vector<int> expected(50);
+  std::iota(expected.begin(), expected.end(), 0);
+  EXPECT_EQ(out, expected);
+  EXPECT_LE(pool.heap_allocations(), 5);
+}
+
+TEST(view_generator_tests, upstream_exception_reaches_consumer) {
+  thread_pool_executor exec(1);
+  auto failing = []() -> generator<shared_buffer<const int>> {
+    auto chunk = shared_buffer<int>::allocate(1);
+    chunk[0] = 7;
+    co_yield shared_buffer<const int>(chunk);
+    throw std::runtime_error("read failed");
+  };
+
+  int seen = 0;
+  auto stage = async_stage(failing(), exec);
+  EXPECT_THROW(
+      {
+        for (auto chunk : stage) {
+          seen += chunk[0];
+        }
+      },
+      std::runtime_error
+  );
+  EXPECT_EQ(seen, 7);
+}
+
+TEST(view_generator_tests, consumer_stops_early) {
+  buffer_pool pool;
+  std::atomic<int> produced = 0;
+  {
+    thread_pool_executor exec(2);
+    int consumed = 0;
+    for (auto chunk : async_stage(numbers(pool, 1 << 20, 16, produced), exec, 4)) {
+      EXPECT_EQ(chunk.size(), 16);
+      if (++consumed == 3) {
+        break;
+      }
+    }
+  }
+  EXPECT_LE(produced.load(), 3 + 4 + 1);
+}
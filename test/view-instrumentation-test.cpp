@@ -0,0 +1,186 @@
+#include "contiguous-view.h"
+
+#include <gtest/gtest.h>
+
+// Only built into the instrumented configuration (-DUSE_VIEW_INSTRUMENTATION=ON).
+#ifdef CONTIGUOUS_VIEW_INSTRUMENTATION
+
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace view_instrumentation;
+
+// Stats for the call site at `line` of this file.
+site_stats at(unsigned line) {
+  for (auto& s : snapshot()) {
+    if (s.line == line && s.file.find("view-instrumentation-test.cpp") != std::string::npos) {
+      return s;
+    }
+  }
+  return site_stats{};
+}
+
+std::uint64_t count(const site_stats& s, event e) {
+  return s.counts[static_cast<size_t>(e)];
+}
+
+} // namespace
+
+TEST(view_instrumentation_tests, counts_events_per_call_site) {
+  reset();
+  std::vector<int> data(8);
+
+  const unsigned make = __LINE__ + 2;
+  for (int i = 0; i < 3; ++i) {
+    contiguous_view<int> v(data.data(), data.size());
+    static_cast<void>(v);
+  }
+  EXPECT_EQ(count(at(make), event::view), 3);
+
+  contiguous_view<int> v(data.data(), data.size());
+  const unsigned sub = __LINE__ + 1;
+  auto tail = v.subview(1);
+  const unsigned firsts = __LINE__ + 1;
+  auto head = v.first(2);
+  const unsigned lasts = __LINE__ + 1;
+  auto tip = head.last<1>();
+  const unsigned bytes = __LINE__ + 1;
+  auto raw = v.as_bytes();
+  EXPECT_EQ(tail.size() + head.size() + tip.size() + raw.size(), 7 + 2 + 1 + 32);
+
+  EXPECT_EQ(count(at(sub), event::subview), 1);
+  EXPECT_EQ(count(at(sub), event::view), 1);
+  EXPECT_EQ(count(at(firsts), event::first), 1);
+  EXPECT_EQ(count(at(lasts), event::last), 1);
+  EXPECT_EQ(count(at(bytes), event::as_bytes), 1);
+  EXPECT_EQ(count(at(bytes), event::view), 1);
+
+  reset();
+  EXPECT_EQ(count(at(sub), event::subview), 0);
+}
+
+TEST(view_instrumentation_tests, sampled_access_strides) {
+  reset();
+  set_sample_period(1);
+  std::vector<int> data(256);
+  std::iota(data.begin(), data.end(), 0);
+
+  const unsigned forward_site = __LINE__ + 1;
+  contiguous_view<const int> forward(data.data(), 128);
+  const unsigned backward_site = __LINE__ + 1;
+  contiguous_view<const int> backward(data.data() + 128, 128);
+  long long sum = 0;
+  for (size_t i = 0; i < forward.size(); ++i) {
+    sum += forward[i];
+  }
+  for (size_t i = backward.size(); i-- > 0;) {
+    sum += backward[i];
+  }
+  EXPECT_EQ(sum, 255 * 256 / 2);
+
+  auto f = at(forward_site);
+  EXPECT_EQ(count(f, event::access), 128);
+  EXPECT_GE(f.strides[static_cast<size_t>(stride::next)], 127);
+  auto b = at(backward_site);
+  EXPECT_EQ(count(b, event::access), 128);
+  EXPECT_EQ(b.strides[static_cast<size_t>(stride::previous)], 127);
+  EXPECT_NE(report().find("accesses are sequential"), std::string::npos);
+
+  set_sample_period(4);
+  reset();
+  for (size_t i = 0; i < forward.size(); ++i) {
+    sum += forward[i];
+  }
+  EXPECT_EQ(count(at(forward_site), event::access), 32);
+  EXPECT_THROW(set_sample_period(0), assertion_error);
+  set_sample_period(64);
+}
+
+TEST(view_instrumentation_tests, strides_per_view) {
+  reset();
+  set_sample_period(1);
+  std::vector<int> a(4096, 1);
+  std::vector<int> b(4096, 2);
+
+  const unsigned a_site = __LINE__ + 1;
+  contiguous_view<const int> va(a.data(), a.size());
+  const unsigned b_site = __LINE__ + 1;
+  contiguous_view<const int> vb(b.data(), b.size());
+  long long sum = 0;
+  for (size_t i = 0; i < va.size(); ++i) {
+    sum += va[i] + vb[i];
+  }
+  EXPECT_EQ(sum, 3 * 4096);
+  set_sample_period(64);
+
+  for (unsigned line : {a_site, b_site}) {
+    auto s = at(line);
+    EXPECT_EQ(s.strides[static_cast<size_t>(stride::next)], 4095);
+    EXPECT_EQ(s.strides[static_cast<size_t>(stride::far)], 0);
+  }
+  auto text = report();
+  EXPECT_NE(text.find("subviews  first/last"), std::string::npos);
+  EXPECT_NE(text.find("accesses are sequential"), std::string::npos);
+}
+
+TEST(view_instrumentation_tests, fixed_size_hint) {
+  reset();
+  std::vector<int> data(64);
+
+  const unsigned fixed = __LINE__ + 2;
+  for (size_t i = 0; i < 4; ++i) {
+    auto chunk = contiguous_view<int>(data.data() + i * 16, 16);
+    static_cast<void>(chunk);
+  }
+  const unsigned varying = __LINE__ + 2;
+  for (size_t i = 1; i < 4; ++i) {
+    auto chunk = contiguous_view<int>(data.data(), i);
+    static_cast<void>(chunk);
+  }
+  const unsigned already_static = __LINE__ + 1;
+  contiguous_view<int, 16> exact(data.data(), 16);
+  static_cast<void>(exact);
+
+  auto s = at(fixed);
+  EXPECT_TRUE(s.fixed_dynamic_size);
+  EXPECT_EQ(s.size, 16);
+  EXPECT_FALSE(at(varying).fixed_dynamic_size);
+  EXPECT_FALSE(at(already_static).fixed_dynamic_size);
+  EXPECT_NE(report().find("every view here has 16 elements"), std::string::npos);
+}
+
+TEST(view_instrumentation_tests, failures) {
+  reset();
+  std::vector<int> data(4);
+  const unsigned owner = __LINE__ + 1;
+  contiguous_view<int> v(data.data(), data.size());
+
+  EXPECT_THROW(v[4], assertion_error);
+  EXPECT_EQ(count(at(owner), event::access_failure), 1);
+
+  const unsigned bad_subview = __LINE__ + 1;
+  EXPECT_THROW(v.subview(5), assertion_error);
+  EXPECT_EQ(count(at(bad_subview), event::assert_failure), 1);
+}
+
+TEST(view_instrumentation_tests, trace_lists_sites) {
+  reset();
+  std::vector<int> data(4);
+  const unsigned line = __LINE__ + 1;
+  contiguous_view<int> v(data.data(), data.size());
+  static_cast<void>(v);
+
+  std::ostringstream out;
+  write_trace(out);
+  auto trace = out.str();
+  EXPECT_EQ(trace.rfind("{\"traceEvents\":[", 0), 0);
+  EXPECT_NE(trace.find("view-instrumentation-test.cpp:" + std::to_string(line) + ":"), std::string::npos);
+  EXPECT_NE(trace.find("\"ph\":\"C\""), std::string::npos);
+  EXPECT_NE(trace.find("\"sample_period\":64"), std::string::npos);
+}
+
+#endif
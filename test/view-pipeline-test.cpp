@@ -0,0 +1,117 @@
+#include "view-pipeline.h"
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <vector>
+
+TEST(view_pipeline_tests, map_sum) {
+  std::array<int, 4> a{1, 2, 3, 4};
+  contiguous_view<const int, 4> v(a.begin(), a.end());
+
+  auto p = pipeline(v).map([](int x) { return x * x; });
+
+  EXPECT_EQ(decltype(p)::extent, 4);
+  EXPECT_EQ(p.sum(), 30);
+  EXPECT_EQ(p.count(), 4);
+}
+
+TEST(view_pipeline_tests, where_reduce) {
+  std::vector<int> a{1, 2, 3, 4, 5, 6};
+  contiguous_view<const int> v(a.begin(), a.end());
+
+  auto p = pipeline(v.subview(1)).where([](int x) { return x % 2 == 0; });
+
+  EXPECT_EQ(p.sum(), 12);
+  EXPECT_EQ(p.count(), 3);
+  EXPECT_EQ(p.reduce(1, [](int acc, int x) { return acc * x; }), 48);
+}
+
+TEST(view_pipeline_tests, zip_with) {
+  std::array<int, 3> a{1, 2, 3};
+  std::array<double, 3> b{0.5, 1.5, 2.5};
+  contiguous_view<const int, 3> va(a.begin(), a.end());
+  contiguous_view<const double> vb(b.begin(), b.end());
+
+  auto p = pipeline(va).zip_with(vb, [](int x, double y) { return x * y; });
+
+  EXPECT_EQ(decltype(p)::extent, 3);
+  EXPECT_DOUBLE_EQ(p.sum(), 0.5 + 3.0 + 7.5);
+}
+
+TEST(view_pipeline_tests, store_into) {
+  std::array<int, 3> a{1, 2, 3};
+  std::array<long, 3> out{};
+  contiguous_view<const int, 3> v(a.begin(), a.end());
+
+  size_t written = pipeline(v).map([](int x) { return x * 10L; }).store_into(contiguous_view<long, 3>(out.begin(), 3));
+
+  EXPECT_EQ(written, 3);
+  EXPECT_EQ(out, (std::array<long, 3>{10, 20, 30}));
+}
+
+TEST(view_pipeline_tests, store_into_filtered) {
+  std::vector<int> a{5, -1, 7, -3, 9};
+  std::vector<int> out(a.size());
+
+  size_t written = pipeline(contiguous_view<const int>(a.begin(), a.end()))
+                       .where([](int x) { return x > 0; })
+                       .map([](int x) { return x + 1; })
+                       .store_into(contiguous_view<int>(out.begin(), out.end()));
+
+  EXPECT_EQ(written, 3);
+  EXPECT_EQ(out[0], 6);
+  EXPECT_EQ(out[1], 8);
+  EXPECT_EQ(out[2], 10);
+}
+
+TEST(view_pipeline_tests, functors_run_once_per_element) {
+  std::vector<int> a{1, 2, 3, 4, 5, 6, 7, 8};
+  contiguous_view<const int> v(a.begin(), a.end());
+  int first_map = 0;
+  int first_where = 0;
+  int second_map = 0;
+  int second_where = 0;
+
+  auto p = pipeline(v)
+               .map([&](int x) {
+                 ++first_map;
+                 return x * 3;
+               })
+               .where([&](int x) {
+                 ++first_where;
+                 return x % 2 == 0;
+               })
+               .map([&](int x) {
+                 ++second_map;
+                 return x + 1;
+               })
+               .where([&](int x) {
+                 ++second_where;
+                 return x > 10;
+               });
+
+  // 3x: 3 6 9 12 15 18 21 24; even: 6 12 18 24; +1: 7 13 19 25; > 10: 13 19 25.
+  EXPECT_EQ(p.sum(), 13 + 19 + 25);
+  EXPECT_EQ(first_map, 8);
+  EXPECT_EQ(first_where, 8);
+  EXPECT_EQ(second_map, 4);
+  EXPECT_EQ(second_where, 4);
+
+  std::vector<int> out(a.size());
+  EXPECT_EQ(p.store_into(contiguous_view<int>(out.begin(), out.end())), 3);
+  EXPECT_EQ(p.count(), 3);
+  EXPECT_EQ(first_map, 24);
+  EXPECT_EQ(second_map, 12);
+}
+
+TEST(view_pipeline_tests, size_mismatch) {
+  std::vector<int> a{1, 2, 3};
+  std::vector<int> b{1, 2};
+  std::vector<int> out(4);
+  contiguous_view<const int> va(a.begin(), a.end());
+  contiguous_view<const int> vb(b.begin(), b.end());
+
+  EXPECT_THROW(pipeline(va).zip_with(vb, std::plus<>{}), assertion_error);
+  EXPECT_THROW(pipeline(va).store_into(contiguous_view<int>(out.begin(), out.end())), assertion_error);
+}